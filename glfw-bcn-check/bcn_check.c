@@ -0,0 +1,104 @@
+#include "glad/glad.h"
+#include "GLFW/glfw3.h"
+#include "utils/utils.h"
+#include "utils/image.h"
+#include "utils/bcn.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+
+// Block compresses a texture in every format at every quality and prints the PSNR of
+// each mip level against the uncompressed source. Exits non-zero if a format's top
+// level falls below its threshold, or if the multithreaded encoder disagrees with the
+// single-threaded one. Runs on the CPU only; no window is opened.
+
+typedef struct
+{
+    const char* name;
+    ImageFormat format;
+    // Least acceptable PSNR of level 0 in dB at any quality; about 1 dB under what
+    // the fast quality gives on graphite.jpg.
+    double minimumPsnr;
+} FormatCase;
+
+static const char* qualityNames[] = {"fast", "normal", "high"};
+
+static int LoadSource(const unsigned char* bytes, size_t size, Image* image)
+{
+    return Image_LoadFromMemory(bytes, size, IMAGE_FLAG_MIPMAPS, image);
+}
+
+int main(int argc, char** argv)
+{
+    const char* fileName = argc > 1 ? argv[1] : "../glfw-textures-ex/graphite.jpg";
+    assert(glfwInit());
+
+    size_t size;
+    unsigned char* bytes = Utils_ReadBinaryFile(fileName, &size);
+    Image original;
+    if (!bytes || !LoadSource(bytes, size, &original))
+    {
+        printf("Could not load %s\n", fileName);
+        return 1;
+    }
+    // At least a few threads, so the threaded path is compared even on one core.
+    long threadCount = sysconf(_SC_NPROCESSORS_ONLN);
+    threadCount = threadCount > 4 ? threadCount : 4;
+    printf("%s: %dx%d, %d channels, %d levels, %ld threads\n", fileName, original.width, original.height,
+           original.channelCount, original.levelCount, threadCount);
+
+    FormatCase formats[] =
+    {
+        {"BC1", ImageFormat_BC1, 27.0},
+        {"BC3", ImageFormat_BC3, 28.5},
+        {"BC4", ImageFormat_BC4, 33.0},
+        {"BC5", ImageFormat_BC5, 33.0},
+    };
+
+    int failures = 0;
+    printf("%-4s %-7s %9s %9s  %s\n", "fmt", "quality", "ms", "level 0", "PSNR dB by level");
+    for (int f = 0; f < (int)ArraySize(formats); ++f)
+    {
+        for (int q = BcnQuality_Fast; q <= BcnQuality_High; ++q)
+        {
+            Image compressed, reference;
+            assert(LoadSource(bytes, size, &compressed) && LoadSource(bytes, size, &reference));
+
+            double start = glfwGetTime();
+            assert(Bcn_CompressImage(&compressed, formats[f].format, (BcnQuality)q, (int)threadCount));
+            double elapsed = glfwGetTime() - start;
+            assert(Bcn_CompressImage(&reference, formats[f].format, (BcnQuality)q, 1));
+
+            double top = Bcn_ComputePsnr(&original, &compressed, 0);
+            printf("%-4s %-7s %9.1f %9.2f ", formats[f].name, qualityNames[q], elapsed * 1000.0, top);
+            for (int level = 1; level < compressed.levelCount; ++level)
+            {
+                printf(" %.1f", Bcn_ComputePsnr(&original, &compressed, level));
+            }
+
+            if (compressed.dataSize != reference.dataSize || memcmp(compressed.data, reference.data, compressed.dataSize))
+            {
+                printf("  FAILED: threaded output differs");
+                ++failures;
+            }
+            if (top < formats[f].minimumPsnr)
+            {
+                printf("  FAILED: below %.1f dB", formats[f].minimumPsnr);
+                ++failures;
+            }
+            printf("\n");
+
+            Image_Free(&compressed);
+            Image_Free(&reference);
+        }
+    }
+
+    Image_Free(&original);
+    free(bytes);
+    glfwTerminate();
+    printf(failures ? "%d checks failed\n" : "All checks passed\n", failures);
+    return failures ? 1 : 0;
+}
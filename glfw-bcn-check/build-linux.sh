@@ -0,0 +1,8 @@
+#!/bin/sh
+
+# Runs on the CPU; ./bcn_check.out [image] checks another file.
+INCLUDES="-I../include"
+LINKER_FLAGS="-lglfw -lGL -lpthread -ldl -lm"
+SOURCES="*.c ../src/*/*.c"
+
+cc $SOURCES $INCLUDES $LINKER_FLAGS -Wall -O2 -o bcn_check.out
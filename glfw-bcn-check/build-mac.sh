@@ -0,0 +1,7 @@
+#!/bin/sh
+
+INCLUDES="-I../include"
+LINKER_FLAGS="-L../libs -lglfw3 -framework OpenGL -framework Cocoa -framework IOkit -framework CoreVideo"
+SOURCES="*.c ../src/*/*.c"
+
+clang $SOURCES $INCLUDES $LINKER_FLAGS -Wall -O2 -o bcn_check.out
@@ -0,0 +1,3 @@
+#!/bin/sh
+
+rm -r *.out *.dSYM
\ No newline at end of file
@@ -0,0 +1,515 @@
+#include "glad/glad.h"
+#include "GLFW/glfw3.h"
+#include "utils/utils.h"
+#include "utils/progcache.h"
+#include "utils/shadervariants.h"
+#include "utils/meshpool.h"
+#include "utils/instances.h"
+#include "utils/vertexformat.h"
+#include "utils/streamring.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <assert.h>
+#include <math.h>
+
+// Measures how many small triangles per second reach the GPU with one draw call per
+// object against one instanced draw for all of them, then how fast vertices are
+// fetched from full float and from compressed vertex formats, and how geometry rebuilt
+// every frame is best streamed to the GPU. On Linux, LIBGL_ALWAYS_SOFTWARE=1
+// runs it on Mesa's llvmpipe. Drawing goes to an offscreen target of fixed size, so
+// results do not depend on the window.
+
+#define FRAMES 64
+#define TARGET_SIZE 512
+#define MAX_OBJECTS 65536
+#define FETCH_VERTICES (1 << 20)
+#define STREAM_TRIANGLES 8192
+
+// One source for both paths; INSTANCED switches the per-object data to attributes.
+static const char* vertexSource =
+    "#version 330 core\n"
+    "layout (location = 0) in vec3 aPos;\n"
+    "#ifdef INSTANCED\n"
+    "layout (location = 1) in vec2 aOffset;\n"
+    "layout (location = 2) in vec4 aColor;\n"
+    "#else\n"
+    "uniform vec2 aOffset;\n"
+    "uniform vec4 aColor;\n"
+    "#endif\n"
+    "out vec4 color;\n"
+    "void main()\n"
+    "{\n"
+    "    gl_Position = vec4(aPos.xy + aOffset, aPos.z, 1.0);\n"
+    "    color = aColor;\n"
+    "}\n";
+
+static const char* fragmentSource =
+    "#version 330 core\n"
+    "in vec4 color;\n"
+    "out vec4 FragColor;\n"
+    "void main()\n"
+    "{\n"
+    "    FragColor = color;\n"
+    "}\n";
+
+// Reads every attribute so none can be dropped, and puts each point beyond the far
+// plane, so the vertex stage is all that is measured.
+static const char* fetchVertexSource =
+    "#version 330 core\n"
+    "layout (location = 0) in vec3 aPos;\n"
+    "layout (location = 1) in vec2 aUV;\n"
+    "layout (location = 2) in vec3 aNormal;\n"
+    "out vec4 color;\n"
+    "void main()\n"
+    "{\n"
+    "    gl_Position = vec4(aPos.xy, 2.0, 1.0);\n"
+    "    color = vec4(aNormal * 0.5 + 0.5, aUV.x + aUV.y + aPos.z);\n"
+    "}\n";
+
+// Position and colour straight from the vertex, as debug lines or particles would have.
+static const char* streamVertexSource =
+    "#version 330 core\n"
+    "layout (location = 0) in vec2 aPos;\n"
+    "layout (location = 1) in vec4 aColor;\n"
+    "out vec4 color;\n"
+    "void main()\n"
+    "{\n"
+    "    gl_Position = vec4(aPos, 0.0, 1.0);\n"
+    "    color = aColor;\n"
+    "}\n";
+
+typedef struct
+{
+    float position[2];
+    unsigned char color[4];
+} StreamVertex;
+
+typedef struct
+{
+    float offset[2];
+    unsigned char color[4];
+} ObjectInstance;
+
+typedef enum
+{
+    DrawMode_ArraysPerObject,
+    DrawMode_ArraysInstanced,
+    DrawMode_PoolPerObject,
+    DrawMode_PoolInstanced,
+} DrawMode;
+
+typedef struct
+{
+    const char* name;
+    DrawMode mode;
+} DrawCase;
+
+typedef struct
+{
+    GLuint uniformProgram;
+    GLint offsetLocation;
+    GLint colorLocation;
+    GLuint instancedProgram;
+    // The same triangle as plain arrays in its own VAO, and as a pool mesh.
+    GLuint vao;
+    GLuint vbo;
+    MeshPool pool;
+    int mesh;
+    InstanceBuffer instances;
+    ObjectInstance objects[MAX_OBJECTS];
+} Scene;
+
+static void DrawFrame(Scene* scene, DrawMode mode, int objectCount, int* callCount)
+{
+    glClear(GL_COLOR_BUFFER_BIT);
+    switch (mode)
+    {
+        case DrawMode_ArraysPerObject:
+        case DrawMode_PoolPerObject:
+            glUseProgram(scene->uniformProgram);
+            if (mode == DrawMode_ArraysPerObject)
+            {
+                glBindVertexArray(scene->vao);
+            }
+            for (int i = 0; i < objectCount; ++i)
+            {
+                const ObjectInstance* object = scene->objects + i;
+                glUniform2fv(scene->offsetLocation, 1, object->offset);
+                glUniform4f(scene->colorLocation, object->color[0] / 255.0f, object->color[1] / 255.0f,
+                            object->color[2] / 255.0f, object->color[3] / 255.0f);
+                if (mode == DrawMode_ArraysPerObject)
+                {
+                    glDrawArrays(GL_TRIANGLES, 0, 3);
+                }
+                else
+                {
+                    MeshPool_Draw(&scene->pool, scene->mesh);
+                }
+            }
+            *callCount += objectCount;
+            break;
+
+        case DrawMode_ArraysInstanced:
+            glUseProgram(scene->instancedProgram);
+            glBindVertexArray(scene->vao);
+            InstanceBuffer_DrawArrays(&scene->instances, GL_TRIANGLES, 0, 3);
+            ++*callCount;
+            break;
+
+        case DrawMode_PoolInstanced:
+            glUseProgram(scene->instancedProgram);
+            MeshPool_DrawInstanced(&scene->pool, scene->mesh, scene->instances.instanceCount);
+            ++*callCount;
+            break;
+    }
+    // The pool's VAO cache does not see the plain VAO binds above.
+    scene->pool.boundPage = -1;
+}
+
+// Returns objects drawn per second; the instance data is uploaded every frame, as
+// moving objects would need.
+static double Measure(Scene* scene, DrawMode mode, int objectCount, double* callsPerSecond)
+{
+    int instanced = mode == DrawMode_ArraysInstanced || mode == DrawMode_PoolInstanced;
+    int callCount = 0;
+    DrawFrame(scene, mode, objectCount, &callCount);
+    glFinish();
+
+    callCount = 0;
+    double start = glfwGetTime();
+    for (int frame = 0; frame < FRAMES; ++frame)
+    {
+        if (instanced)
+        {
+            InstanceBuffer_Update(&scene->instances, scene->objects, objectCount);
+        }
+        DrawFrame(scene, mode, objectCount, &callCount);
+    }
+    glFinish();
+    double elapsed = glfwGetTime() - start;
+
+    *callsPerSecond = callCount / elapsed;
+    return (double)objectCount * FRAMES / elapsed;
+}
+
+// Returns vertices fetched per second from one draw of a static vertex buffer.
+static double MeasureFetch(const VertexFormat* format, const float* source)
+{
+    void* packed = malloc((size_t)FETCH_VERTICES * format->vertexSize);
+    assert(packed);
+    VertexFormat_Pack(format, source, FETCH_VERTICES, packed);
+
+    GLuint vao, vbo;
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)FETCH_VERTICES * format->vertexSize, packed, GL_STATIC_DRAW);
+    VertexFormat_Apply(format, NULL);
+    free(packed);
+
+    glDrawArrays(GL_POINTS, 0, FETCH_VERTICES);
+    glFinish();
+
+    double start = glfwGetTime();
+    for (int frame = 0; frame < FRAMES; ++frame)
+    {
+        glDrawArrays(GL_POINTS, 0, FETCH_VERTICES);
+    }
+    glFinish();
+    double elapsed = glfwGetTime() - start;
+
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &vbo);
+    return (double)FETCH_VERTICES * FRAMES / elapsed;
+}
+
+static void MeasureVertexFormats(ProgCache* cache, GLFWwindow* window)
+{
+    GLuint program = ProgCache_Build(cache, "fetch", fetchVertexSource, fragmentSource, window);
+    glUseProgram(program);
+
+    // Position, UV and unit normal per vertex, in the ranges the packed encodings cover.
+    float* source = malloc((size_t)FETCH_VERTICES * 8 * sizeof(float));
+    assert(source);
+    for (int i = 0; i < FETCH_VERTICES; ++i)
+    {
+        float* vertex = source + i * 8;
+        float angle = i * 0.001f;
+        vertex[0] = (i % 1024) / 512.0f - 1.0f;
+        vertex[1] = (i / 1024) / 512.0f - 1.0f;
+        vertex[2] = sinf(angle);
+        vertex[3] = (i % 1024) / 1023.0f;
+        vertex[4] = (i / 1024) / 1023.0f;
+        vertex[5] = cosf(angle) * 0.6f;
+        vertex[6] = sinf(angle) * 0.6f;
+        vertex[7] = 0.8f;
+    }
+
+    VertexElement floatElements[] =
+    {
+        {0, 3, VertexEncoding_Float},
+        {1, 2, VertexEncoding_Float},
+        {2, 3, VertexEncoding_Float},
+    };
+    VertexElement packedElements[] =
+    {
+        {0, 3, VertexEncoding_Half},
+        {1, 2, VertexEncoding_Unorm16},
+        {2, 3, VertexEncoding_Snorm10},
+    };
+    struct
+    {
+        const char* name;
+        VertexFormat format;
+    } formats[2] = {{"float pos, uv, normal"}, {"half, unorm16, 10:10:10:2"}};
+    VertexFormat_Init(&formats[0].format, floatElements, ArraySize(floatElements));
+    VertexFormat_Init(&formats[1].format, packedElements, ArraySize(packedElements));
+
+    printf("\n%-26s %14s %14s %14s\n", "vertex format", "bytes/vertex", "buffer MB", "Mvertices/s");
+    for (int f = 0; f < (int)ArraySize(formats); ++f)
+    {
+        const VertexFormat* format = &formats[f].format;
+        double verticesPerSecond = MeasureFetch(format, source);
+        printf("%-26s %14d %14.1f %14.1f\n", formats[f].name, format->vertexSize,
+               (double)FETCH_VERTICES * format->vertexSize / (1024.0 * 1024.0), verticesPerSecond / 1e6);
+    }
+
+    free(source);
+    glDeleteProgram(program);
+}
+
+// Small triangles that drift with the frame number, written the way a particle system
+// rebuilds its vertices each frame.
+static void WriteParticles(StreamVertex* vertices, int frame)
+{
+    static const float corners[3][2] = {{-0.01f, -0.01f}, {0.01f, -0.01f}, {0.0f, 0.01f}};
+    for (int i = 0; i < STREAM_TRIANGLES; ++i)
+    {
+        float x = (i % 128) / 64.0f - 1.0f + sinf(frame * 0.05f + i) * 0.01f;
+        float y = (i / 128) / 32.0f - 1.0f + cosf(frame * 0.05f + i) * 0.01f;
+        for (int c = 0; c < 3; ++c)
+        {
+            StreamVertex* vertex = vertices + i * 3 + c;
+            vertex->position[0] = x + corners[c][0];
+            vertex->position[1] = y + corners[c][1];
+            vertex->color[0] = (unsigned char)(i * 7 + frame);
+            vertex->color[1] = (unsigned char)(i * 13);
+            vertex->color[2] = (unsigned char)(i * 29);
+            vertex->color[3] = 255;
+        }
+    }
+}
+
+// Returns triangles per second for vertices rebuilt every frame: written in place
+// through ring when given, otherwise copied in by glBufferData, which respecifies the
+// buffer each frame. The first STREAMRING_SEGMENTS frames give every segment a fence
+// and are not timed; steadyWaits counts the ring's waits after them.
+static double MeasureStream(StreamRing* ring, int* steadyWaits)
+{
+    size_t frameSize = (size_t)STREAM_TRIANGLES * 3 * sizeof(StreamVertex);
+    StreamVertex* staging = NULL;
+    GLuint vao, vbo = 0;
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    if (ring)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, ring->buffer);
+    }
+    else
+    {
+        staging = malloc(frameSize);
+        assert(staging);
+        glGenBuffers(1, &vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    }
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(StreamVertex), (void*)offsetof(StreamVertex, position));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(StreamVertex), (void*)offsetof(StreamVertex, color));
+    glEnableVertexAttribArray(1);
+
+    double start = 0.0;
+    int waitCount = 0;
+    for (int frame = 0; frame < STREAMRING_SEGMENTS + FRAMES; ++frame)
+    {
+        if (frame == STREAMRING_SEGMENTS)
+        {
+            glFinish();
+            start = glfwGetTime();
+            waitCount = ring ? ring->waitCount : 0;
+        }
+
+        glClear(GL_COLOR_BUFFER_BIT);
+        GLint first = 0;
+        if (ring)
+        {
+            StreamRing_BeginFrame(ring);
+            GLintptr offset;
+            StreamVertex* vertices = StreamRing_Alloc(ring, frameSize, sizeof(StreamVertex), &offset);
+            assert(vertices);
+            WriteParticles(vertices, frame);
+            StreamRing_Commit(ring);
+            // The attribute pointers stay at the start of the buffer; the offset is a vertex index.
+            first = (GLint)(offset / sizeof(StreamVertex));
+        }
+        else
+        {
+            WriteParticles(staging, frame);
+            glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)frameSize, staging, GL_STREAM_DRAW);
+        }
+        glDrawArrays(GL_TRIANGLES, first, STREAM_TRIANGLES * 3);
+        if (ring)
+        {
+            StreamRing_EndFrame(ring);
+        }
+    }
+    glFinish();
+    double elapsed = glfwGetTime() - start;
+
+    *steadyWaits = ring ? ring->waitCount - waitCount : 0;
+    free(staging);
+    glDeleteBuffers(1, &vbo);
+    glDeleteVertexArrays(1, &vao);
+    return (double)STREAM_TRIANGLES * FRAMES / elapsed;
+}
+
+static void MeasureStreaming(ProgCache* cache, GLFWwindow* window)
+{
+    GLuint program = ProgCache_Build(cache, "stream", streamVertexSource, fragmentSource, window);
+    glUseProgram(program);
+
+    // Sized for one frame's vertices, so the ring allocates its storage once and never again.
+    StreamRing ring;
+    StreamRing_Init(&ring, (size_t)STREAM_TRIANGLES * 3 * sizeof(StreamVertex));
+
+    int steadyWaits;
+    printf("\n%-26s %14s\n", "per-frame geometry", "triangles/s");
+    printf("%-26s %14.0f\n", "glBufferData per frame", MeasureStream(NULL, &steadyWaits));
+    printf("%-26s %14.0f\n", "StreamRing", MeasureStream(&ring, &steadyWaits));
+    StreamRing_Report(&ring);
+    printf("%d waits over the %d timed frames, one buffer allocation\n", steadyWaits, FRAMES);
+
+    StreamRing_Free(&ring);
+    glDeleteProgram(program);
+}
+
+static GLuint BuildProgram(ProgCache* cache, const char* name, const char* defines, GLFWwindow* window)
+{
+    char* vertSrc = ShaderVariants_Source(vertexSource, defines);
+    char* fragSrc = ShaderVariants_Source(fragmentSource, defines);
+    GLuint result = ProgCache_Build(cache, name, vertSrc, fragSrc, window);
+    free(vertSrc);
+    free(fragSrc);
+    return result;
+}
+
+int main()
+{
+    assert(glfwInit());
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* window = Utils_CreateWindow("Draw benchmark");
+    assert(window);
+    assert(gladLoadGLLoader((GLADloadproc)glfwGetProcAddress));
+
+    printf("%s | %s\n", glGetString(GL_RENDERER), glGetString(GL_VERSION));
+
+    GLuint target, framebuffer;
+    glGenRenderbuffers(1, &target);
+    glBindRenderbuffer(GL_RENDERBUFFER, target);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, TARGET_SIZE, TARGET_SIZE);
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, target);
+    assert(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+    glViewport(0, 0, TARGET_SIZE, TARGET_SIZE);
+    glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+
+    Scene* scene = calloc(1, sizeof(Scene));
+    assert(scene);
+
+    // No cache directory: every run compiles, and nothing is left on disk.
+    ProgCache programs;
+    ProgCache_Init(&programs, NULL);
+    scene->uniformProgram = BuildProgram(&programs, "per object", "", window);
+    scene->offsetLocation = glGetUniformLocation(scene->uniformProgram, "aOffset");
+    scene->colorLocation = glGetUniformLocation(scene->uniformProgram, "aColor");
+    scene->instancedProgram = BuildProgram(&programs, "instanced", "INSTANCED", window);
+
+    // A triangle a few pixels across, so the numbers measure submission rather than fill.
+    float vertices[] =
+    {
+        -0.01f, -0.01f, 0.0f,
+         0.01f, -0.01f, 0.0f,
+         0.0f,   0.01f, 0.0f
+    };
+    unsigned int indices[] = {0, 1, 2};
+    MeshAttribute position = {0, 3, GL_FLOAT, GL_FALSE, 0};
+    MeshAttribute instanceAttributes[] =
+    {
+        {1, 2, GL_FLOAT, GL_FALSE, offsetof(ObjectInstance, offset)},
+        {2, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(ObjectInstance, color)},
+    };
+    InstanceBuffer_Init(&scene->instances, sizeof(ObjectInstance), instanceAttributes,
+                        ArraySize(instanceAttributes), MAX_OBJECTS);
+
+    glGenVertexArrays(1, &scene->vao);
+    glBindVertexArray(scene->vao);
+    glGenBuffers(1, &scene->vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, scene->vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    InstanceBuffer_Attach(&scene->instances, scene->vao);
+
+    MeshPool_Init(&scene->pool, 3 * sizeof(float), &position, 1, 1024, 1024);
+    scene->mesh = MeshPool_Add(&scene->pool, vertices, 3, indices, 3);
+    InstanceBuffer_AttachPool(&scene->instances, &scene->pool);
+
+    for (int i = 0; i < MAX_OBJECTS; ++i)
+    {
+        ObjectInstance* object = scene->objects + i;
+        object->offset[0] = (i % 256) / 128.0f - 1.0f;
+        object->offset[1] = (i / 256 % 256) / 128.0f - 1.0f;
+        object->color[0] = (unsigned char)(i * 7);
+        object->color[1] = (unsigned char)(i * 13);
+        object->color[2] = (unsigned char)(i * 29);
+        object->color[3] = 255;
+    }
+
+    DrawCase cases[] =
+    {
+        {"glDrawArrays per object", DrawMode_ArraysPerObject},
+        {"glDrawArraysInstanced", DrawMode_ArraysInstanced},
+        {"MeshPool_Draw per object", DrawMode_PoolPerObject},
+        {"MeshPool_DrawInstanced", DrawMode_PoolInstanced},
+    };
+    int objectCounts[] = {16, 256, 4096, MAX_OBJECTS};
+
+    printf("%7s  %-26s %14s %14s\n", "objects", "path", "objects/s", "draw calls/s");
+    for (int o = 0; o < (int)ArraySize(objectCounts); ++o)
+    {
+        for (int c = 0; c < (int)ArraySize(cases); ++c)
+        {
+            double callsPerSecond;
+            double objectsPerSecond = Measure(scene, cases[c].mode, objectCounts[o], &callsPerSecond);
+            printf("%7d  %-26s %14.0f %14.0f\n", objectCounts[o], cases[c].name, objectsPerSecond, callsPerSecond);
+        }
+    }
+
+    MeasureVertexFormats(&programs, window);
+    MeasureStreaming(&programs, window);
+
+    MeshPool_Free(&scene->pool);
+    InstanceBuffer_Free(&scene->instances);
+    glDeleteVertexArrays(1, &scene->vao);
+    glDeleteBuffers(1, &scene->vbo);
+    glDeleteProgram(scene->uniformProgram);
+    glDeleteProgram(scene->instancedProgram);
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteRenderbuffers(1, &target);
+    free(scene);
+    glfwDestroyWindow(window);
+    glfwTerminate();
+}
@@ -1,3 +1,3 @@
 #!/bin/sh
 
-rm -r *.out *.dSYM
\ No newline at end of file
+rm -r *.out *.dSYM embedded_shaders.h
\ No newline at end of file
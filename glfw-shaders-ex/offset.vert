@@ -1,7 +1,10 @@
 #version 330 core
 layout(location = 0) in vec3 position;
 
-uniform float horizontalOffset;
+layout(std140) uniform PerDraw
+{
+    float horizontalOffset;
+};
 
 void main()
 {
@@ -1,6 +1,14 @@
 #include "glad/glad.h"
 #include "GLFW/glfw3.h"
 #include "utils/utils.h"
+#include "utils/progcache.h"
+#include "utils/hotreload.h"
+#include "utils/preprocessor.h"
+#include "utils/uniformring.h"
+#include "utils/std140.h"
+#include "utils/shaderfiles.h"
+#include "utils/shaderstats.h"
+#include "embedded_shaders.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -45,30 +53,18 @@ void FirstSolution()
     glfwSetKeyCallback(window, KeyPressed);
     glfwSetFramebufferSizeCallback(window, ResizeFrameBuffer);
 
-    const char* vertSrc = Utils_ReadTextFile("upside_down.vert");
-    const char* fragSrc = Utils_ReadTextFile("orange.frag");
-    Assert(vertSrc && fragSrc, "Shader loading error.");
+    // #include "file" resolves relative to the including shader.
+    Preprocessor preprocessor;
+    Preprocessor_Init(&preprocessor, ShaderBatch_PrintError, NULL);
+    const ShaderExpansion* vert = Preprocessor_Expand(&preprocessor, "upside_down.vert");
+    const ShaderExpansion* frag = Preprocessor_Expand(&preprocessor, "orange.frag");
+    Assert(vert && frag, "Shader loading error.");
 
-    GLuint vertShdr = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertShdr, 1, &vertSrc, NULL);
-    glCompileShader(vertShdr);
-    Utils_CheckShaderState(vertShdr, window);
-
-    GLuint fragShdr = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragShdr, 1, &fragSrc, NULL);
-    glCompileShader(fragShdr);
-    Utils_CheckShaderState(fragShdr, window);
-
-    GLuint program = glCreateProgram();
-    glAttachShader(program, vertShdr);
-    glAttachShader(program, fragShdr);
-    glLinkProgram(program);
-    Utils_CheckProgramState(program, window);
-
-    glDeleteShader(vertShdr);
-    glDeleteShader(fragShdr);
-    free((void*)fragSrc);
-    free((void*)vertSrc);
+    ProgCache programs;
+    ProgCache_Init(&programs, "shadercache");
+    GLuint program = ProgCache_Build(&programs, "upside_down.vert, orange.frag", vert->text, frag->text, window);
+    ProgCache_Report(&programs);
+    Preprocessor_Free(&preprocessor);
 
     glUseProgram(program);
 
@@ -115,32 +111,26 @@ void SecondSolution()
     glfwSetKeyCallback(window, KeyPressed);
     glfwSetFramebufferSizeCallback(window, ResizeFrameBuffer);
 
-    const char* vertSrc = Utils_ReadTextFile("offset.vert");
-    const char* fragSrc = Utils_ReadTextFile("orange.frag");
-    Assert(vertSrc && fragSrc, "Shader loading error.");
-
-    GLuint vertShdr = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertShdr, 1, &vertSrc, NULL);
-    glCompileShader(vertShdr);
-    Utils_CheckShaderState(vertShdr, window);
-
-    GLuint fragShdr = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragShdr, 1, &fragSrc, NULL);
-    glCompileShader(fragShdr);
-    Utils_CheckShaderState(fragShdr, window);
-
-    GLuint program = glCreateProgram();
-    glAttachShader(program, vertShdr);
-    glAttachShader(program, fragShdr);
-    glLinkProgram(program);
-    Utils_CheckProgramState(program, window);
-
-    glDeleteShader(vertShdr);
-    glDeleteShader(fragShdr);
-    free((void*)fragSrc);
-    free((void*)vertSrc);
-
-    int offsetParamLocation = glGetUniformLocation(program, "horizontalOffset");
+    const char* vertPath = "offset.vert";
+    const char* fragPath = "orange.frag";
+    Preprocessor preprocessor;
+    Preprocessor_Init(&preprocessor, ShaderBatch_PrintError, NULL);
+    const ShaderExpansion* vert = Preprocessor_Expand(&preprocessor, vertPath);
+    const ShaderExpansion* frag = Preprocessor_Expand(&preprocessor, fragPath);
+    Assert(vert && frag, "Shader loading error.");
+
+    ProgCache programs;
+    ProgCache_Init(&programs, "shadercache");
+    GLuint program = ProgCache_Build(&programs, "offset.vert, orange.frag", vert->text, frag->text, window);
+    ProgCache_Report(&programs);
+
+    // Saved edits to either file, or anything they include, are rebuilt and swapped in while running.
+    HotReload reload;
+    HotReload_Init(&reload, &preprocessor, ShaderBatch_PrintError, NULL);
+    int shader = HotReload_Add(&reload, vertPath, fragPath, program);
+    ProgramInfo* info = HotReload_Info(&reload, shader);
+    ProgramInfo_BindBlock(info, ProgramInfo_Block(info, "PerDraw"), 0);
+    int generation = HotReload_Generation(&reload, shader);
     glUseProgram(program);
 
     float vertices[] = 
@@ -161,29 +151,52 @@ void SecondSolution()
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 3, 0);
     glEnableVertexAttribArray(0);
 
+    // The offset lives in the PerDraw uniform block, packed into a ring buffer each frame.
+    UniformRing uniforms;
+    UniformRing_Init(&uniforms, 4096);
+
     float offset = 0.0f;
     while (!glfwWindowShouldClose(window))
     {
+        HotReload_Update(&reload);
+        if (HotReload_Generation(&reload, shader) != generation)
+        {
+            generation = HotReload_Generation(&reload, shader);
+            glUseProgram(HotReload_Program(&reload, shader));
+            info = HotReload_Info(&reload, shader);
+            ProgramInfo_BindBlock(info, ProgramInfo_Block(info, "PerDraw"), 0);
+        }
+
         glClearColor(0.2f, 0.2f, 0.2f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
 
         if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS)
         {
             offset += 0.01f;
-            glUniform1f(offsetParamLocation, offset);
         }
         else if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS)
         {
             offset -= 0.01f;
-            glUniform1f(offsetParamLocation, offset);
         }
 
+        UniformRing_BeginFrame(&uniforms);
+        GLintptr perDraw;
+        Std140Writer writer;
+        Std140_Init(&writer, UniformRing_Alloc(&uniforms, 16, &perDraw), 16);
+        Std140_Float(&writer, offset);
+        UniformRing_Bind(&uniforms, 0, perDraw, (GLsizeiptr)Std140_Size(&writer));
+
         glDrawArrays(GL_TRIANGLES, 0, 3);
+        UniformRing_EndFrame(&uniforms);
 
         glfwPollEvents();
         glfwSwapBuffers(window);
     }
 
+    // The reload owns the current program; everything here needs the context still alive.
+    UniformRing_Free(&uniforms);
+    HotReload_Free(&reload);
+    Preprocessor_Free(&preprocessor);
     CleanUp();
 }
 
@@ -199,31 +212,23 @@ void ThirdSolution()
     glfwSetKeyCallback(window, KeyPressed);
     glfwSetFramebufferSizeCallback(window, ResizeFrameBuffer);
 
-    const char* vertSrc = Utils_ReadTextFile("default.vert");
-    const char* fragSrc = Utils_ReadTextFile("colorPos.frag");
-    Assert(vertSrc && fragSrc, "Shader loading error.");
-
-    GLuint vertShdr = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertShdr, 1, &vertSrc, NULL);
-    glCompileShader(vertShdr);
-    Utils_CheckShaderState(vertShdr, window);
-
-    GLuint fragShdr = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragShdr, 1, &fragSrc, NULL);
-    glCompileShader(fragShdr);
-    Utils_CheckShaderState(fragShdr, window);
-
-    GLuint program = glCreateProgram();
-    glAttachShader(program, vertShdr);
-    glAttachShader(program, fragShdr);
-    glLinkProgram(program);
-    Utils_CheckProgramState(program, window);
-
-    glDeleteShader(vertShdr);
-    glDeleteShader(fragShdr);
-    free((void*)fragSrc);
-    free((void*)vertSrc);
-
+    const char* vertPath = "default.vert";
+    const char* fragPath = "colorPos.frag";
+    Preprocessor preprocessor;
+    Preprocessor_Init(&preprocessor, ShaderBatch_PrintError, NULL);
+    const ShaderExpansion* vert = Preprocessor_Expand(&preprocessor, vertPath);
+    const ShaderExpansion* frag = Preprocessor_Expand(&preprocessor, fragPath);
+    Assert(vert && frag, "Shader loading error.");
+
+    ProgCache programs;
+    ProgCache_Init(&programs, "shadercache");
+    GLuint program = ProgCache_Build(&programs, "default.vert, colorPos.frag", vert->text, frag->text, window);
+    ProgCache_Report(&programs);
+
+    HotReload reload;
+    HotReload_Init(&reload, &preprocessor, ShaderBatch_PrintError, NULL);
+    int shader = HotReload_Add(&reload, vertPath, fragPath, program);
+    int generation = HotReload_Generation(&reload, shader);
     glUseProgram(program);
 
     float vertices[] = 
@@ -246,6 +251,13 @@ void ThirdSolution()
 
     while (!glfwWindowShouldClose(window))
     {
+        HotReload_Update(&reload);
+        if (HotReload_Generation(&reload, shader) != generation)
+        {
+            generation = HotReload_Generation(&reload, shader);
+            glUseProgram(HotReload_Program(&reload, shader));
+        }
+
         glClearColor(0.2f, 0.2f, 0.2f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
 
@@ -255,10 +267,17 @@ void ThirdSolution()
         glfwSwapBuffers(window);
     }
 
+    HotReload_Free(&reload);
+    Preprocessor_Free(&preprocessor);
     CleanUp();
 }
 
 int main()
 {
+    // Shaders are compiled in by build-mac.sh; run with SHADERS_FROM_DISK=1 to edit
+    // the files and have hot reload pick the changes up. Shader build times are printed
+    // at exit, or written as JSON to $SHADER_STATS_JSON.
+    ShaderFiles_Register(embeddedShaders, EMBEDDED_SHADER_COUNT);
+    ShaderStats_ReportAtExit(getenv("SHADER_STATS_JSON"));
     ThirdSolution();
 }
\ No newline at end of file
@@ -0,0 +1,12 @@
+#version 330 core
+out vec4 fragColor;
+
+in vec2 texCoord;
+flat in float layer;
+
+uniform sampler2DArray uTextures;
+
+void main()
+{
+    fragColor = texture(uTextures, vec3(texCoord, layer));
+}
\ No newline at end of file
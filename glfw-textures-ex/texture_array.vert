@@ -0,0 +1,14 @@
+#version 330 core
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec2 inTextCoord;
+layout(location = 2) in float inLayer;
+
+out vec2 texCoord;
+flat out float layer;
+
+void main()
+{
+    gl_Position = vec4(inPosition, 1.0f);
+    texCoord = inTextCoord;
+    layer = inLayer;
+}
\ No newline at end of file
@@ -1,9 +1,24 @@
 #include "glad/glad.h"
 #include "GLFW/glfw3.h"
 #include "utils/utils.h"
-#define STB_IMAGE_IMPLEMENTATION
-#include "utils/stb_image.h"
+#include "utils/image.h"
+#include "utils/loader.h"
+#include "utils/uploader.h"
+#include "utils/texregistry.h"
+#include "utils/progcache.h"
+#include "utils/programinfo.h"
+#include "utils/bcn.h"
+#include "utils/shaderfiles.h"
+#include "utils/shaderstats.h"
+#include "utils/vertexformat.h"
+#include "utils/atlas.h"
+#include "utils/texstream.h"
+#include "embedded_shaders.h"
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
 #include <assert.h>
 
 void FrameBufferSizeCallback(GLFWwindow* window, int width, int height)
@@ -19,88 +34,476 @@ void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods
     }
 }
 
-// ex-1: Make sure only the happy face looks in the other/reverse direction by changing the fragment shader.
+// Position (3 floats) and UV (2 floats) per vertex, at texture.vert's locations.
+GLuint CreateQuadVAO(const float* vertices, int vertexCount, GLuint* vbo)
+{
+    GLuint vao;
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glGenBuffers(1, vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, *vbo);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)vertexCount * 5 * sizeof(float), vertices, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    return vao;
+}
 
-int main()
+// Compiled-in shaders are built straight from the embedded table, keyed by the hashes
+// embed_shaders computed, so neither source is copied or hashed at startup.
+GLuint BuildProgram(ProgCache* programs, const char* vertPath, const char* fragPath, GLFWwindow* window)
 {
-    assert(glfwInit());
-    GLFWwindow* window = Utils_CreateWindow("Textures exercises");
-    assert(window);
-    assert(gladLoadGLLoader((GLADloadproc)glfwGetProcAddress));
+    char name[256];
+    snprintf(name, sizeof(name), "%s, %s", vertPath, fragPath);
 
-    glfwSetFramebufferSizeCallback(window, FrameBufferSizeCallback);
-    glfwSetKeyCallback(window, KeyCallback);
+    const EmbeddedShader* vert = ShaderFiles_Find(vertPath);
+    const EmbeddedShader* frag = ShaderFiles_Find(fragPath);
+    if (vert && frag)
+    {
+        uint64_t key = ProgCache_KeyFromHashes(vert->hash, frag->hash);
+        return ProgCache_BuildWithKey(programs, name, key, vert->source, frag->source, window);
+    }
 
-    const char* vertSrc = Utils_ReadTextFile("texture.vert");
-    const char* fragSrc = Utils_ReadTextFile("texture.frag");
+    char* vertSrc = ShaderFiles_Read(vertPath);
+    char* fragSrc = ShaderFiles_Read(fragPath);
     assert(vertSrc);
     assert(fragSrc);
+    GLuint result = ProgCache_Build(programs, name, vertSrc, fragSrc, window);
+    free(vertSrc);
+    free(fragSrc);
+    return result;
+}
 
-    GLuint vertShdr = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertShdr, 1, &vertSrc, 0);
-    glCompileShader(vertShdr);
-    Utils_CheckShaderState(vertShdr, window);
+// A checkerboard in two colours picked from seed, standing in for an icon or glyph.
+void CreatePattern(Image* image, int width, int height, int seed)
+{
+    memset(image, 0, sizeof(*image));
+    image->width = width;
+    image->height = height;
+    image->channelCount = 4;
+    image->levelCount = 1;
+    image->levels[0].width = width;
+    image->levels[0].height = height;
+    image->levels[0].size = (size_t)width * height * 4;
+    image->dataSize = image->levels[0].size;
+    image->data = malloc(image->dataSize);
+    assert(image->data);
 
-    GLuint fragShdr = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragShdr, 1, &fragSrc, 0);
-    glCompileShader(fragShdr);
-    Utils_CheckShaderState(fragShdr, window);
+    unsigned char colors[2][4] =
+    {
+        {(unsigned char)(seed * 67), (unsigned char)(seed * 131), (unsigned char)(seed * 197), 255},
+        {(unsigned char)(255 - seed * 29), (unsigned char)(seed * 53), (unsigned char)(128 + seed * 11), 255},
+    };
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            memcpy(image->data + ((size_t)y * width + x) * 4, colors[(x / 8 + y / 8) & 1], 4);
+        }
+    }
+}
+
+// Many small images packed into one atlas page and drawn with a single call.
+void AtlasExample(GLFWwindow* window)
+{
+    enum { ImageCount = 24 };
+    Image images[ImageCount];
+    AtlasRect rects[ImageCount];
+    for (int i = 0; i < ImageCount; ++i)
+    {
+        CreatePattern(images + i, 16 + (i * 37) % 80, 16 + (i * 53) % 64, i + 1);
+    }
+
+    // A 4 texel gutter keeps the first two mip levels free of neighbouring images.
+    Atlas atlas;
+    Atlas_Init(&atlas, 512, 4, IMAGE_FLAG_MIPMAPS);
+    assert(Atlas_AddBatch(&atlas, images, ImageCount, rects));
+    assert(Atlas_Finish(&atlas));
+    for (int i = 0; i < ImageCount; ++i)
+    {
+        Image_Free(images + i);
+    }
 
-    GLuint program = glCreateProgram();
-    glAttachShader(program, vertShdr);
-    glAttachShader(program, fragShdr);
-    glLinkProgram(program);
-    Utils_CheckProgramState(program, window);
+    // Quads in a 6 x 4 grid, sized by their images; one draw per atlas page.
+    float* vertices = malloc(ImageCount * 6 * 5 * sizeof(float));
+    assert(vertices);
+    int pageStarts[ATLAS_MAX_PAGES + 1] = {0};
+    int vertexCount = 0;
+    for (int page = 0; page < atlas.pageCount; ++page)
+    {
+        pageStarts[page] = vertexCount;
+        for (int i = 0; i < ImageCount; ++i)
+        {
+            if (rects[i].page != page)
+            {
+                continue;
+            }
+            float x = -0.9f + (i % 6) * 0.3f;
+            float y = 0.5f - (i / 6) * 0.45f;
+            float w = (rects[i].u1 - rects[i].u0) * atlas.pageSize / 400.0f;
+            float h = (rects[i].v1 - rects[i].v0) * atlas.pageSize / 400.0f;
+            Atlas_WriteQuad(rects + i, x, y, x + w, y + h, vertices + vertexCount * 5);
+            vertexCount += 6;
+        }
+    }
+    pageStarts[atlas.pageCount] = vertexCount;
 
+    GLuint textures[ATLAS_MAX_PAGES];
+    for (int page = 0; page < atlas.pageCount; ++page)
+    {
+        textures[page] = Atlas_CreateTexture(&atlas, page);
+    }
+    GLuint vbo;
+    GLuint vao = CreateQuadVAO(vertices, vertexCount, &vbo);
+    free(vertices);
+    printf("Atlas: %d images in %d page(s) of %dx%d, %d mip levels, %d draw call(s) a frame\n",
+           ImageCount, atlas.pageCount, atlas.pageSize, atlas.pageSize, atlas.levelCount, atlas.pageCount);
+
+    ProgCache programs;
+    ProgCache_Init(&programs, "shadercache");
+    GLuint program = BuildProgram(&programs, "texture.vert", "texture.frag", window);
+    ProgCache_Report(&programs);
     glUseProgram(program);
-    
-    int w, h, channelCount;
-    unsigned char* imageData = stbi_load("graphite.jpg", &w, &h, &channelCount, 0);
-    assert(imageData);
-
-    GLuint texture;
-    glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);	
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, w, h, 0, GL_RGB, GL_UNSIGNED_BYTE, imageData);
-    glGenerateMipmap(texture);
+    glUniform1i(glGetUniformLocation(program, "uTexture"), 0);
 
-    float vertices[] = 
+    while (!glfwWindowShouldClose(window))
     {
-        -0.5f, 0.0f, 0.0f, /* */ 0.0f, 0.0f, 
-         0.5f, 0.0f, 0.0f, /* */ 1.0f, 0.0f, 
-         0.0f, 1.0f, 0.0f, /* */ 0.5f, 1.0f, 
-    };
+        glClearColor(0.25f, 0.25f, 0.25f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        for (int page = 0; page < atlas.pageCount; ++page)
+        {
+            glBindTexture(GL_TEXTURE_2D, textures[page]);
+            glDrawArrays(GL_TRIANGLES, pageStarts[page], pageStarts[page + 1] - pageStarts[page]);
+        }
+
+        glfwPollEvents();
+        glfwSwapBuffers(window);
+    }
+
+    glDeleteTextures(atlas.pageCount, textures);
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &vbo);
+    glDeleteProgram(program);
+    Atlas_Free(&atlas);
+}
+
+// Four copies of graphite.jpg that grow and shrink on screen, each holding only the
+// mips its size needs, under a VRAM budget smaller than the four full chains.
+void StreamingExample(GLFWwindow* window)
+{
+    enum { TextureCount = 4 };
+    TexStream stream;
+    TexStream_Init(&stream, 3 << 20, 512 << 10);
+    int handles[TextureCount];
+    for (int i = 0; i < TextureCount; ++i)
+    {
+        Image image;
+        assert(Image_Load("graphite.jpg", IMAGE_FLAG_SRGB | IMAGE_FLAG_MIPMAPS, &image));
+        handles[i] = TexStream_Add(&stream, &image);
+        assert(handles[i] >= 0);
+    }
 
+    // A unit quad, scaled and placed per texture by the vertices rewritten each frame.
+    float vertices[TextureCount * 6 * 5];
     GLuint vbo;
-    glGenBuffers(1, &vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    GLuint vao = CreateQuadVAO(vertices, TextureCount * 6, &vbo);
 
-    GLuint vao;
+    ProgCache programs;
+    ProgCache_Init(&programs, "shadercache");
+    GLuint program = BuildProgram(&programs, "texture.vert", "texture.frag", window);
+    ProgCache_Report(&programs);
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "uTexture"), 0);
+
+    int frame = 0;
+    while (!glfwWindowShouldClose(window))
+    {
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+
+        // Each quad cycles between 16 and 400 pixels across, out of phase with the others.
+        AtlasRect fullImage = {0, 0.0f, 0.0f, 1.0f, 1.0f};
+        for (int i = 0; i < TextureCount; ++i)
+        {
+            float pixels = 16.0f + 384.0f * (0.5f + 0.5f * sinf(frame * 0.02f + i * 1.6f));
+            float w = pixels * 2.0f / width;
+            float h = pixels * 2.0f / height;
+            float x = -0.75f + (i % 2) * 0.8f;
+            float y = -0.75f + (i / 2) * 0.8f;
+            Atlas_WriteQuad(&fullImage, x, y, x + w, y + h, vertices + i * 6 * 5);
+            TexStream_Request(&stream, handles[i], pixels);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
+        TexStream_Update(&stream);
+
+        glClearColor(0.25f, 0.25f, 0.25f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        for (int i = 0; i < TextureCount; ++i)
+        {
+            glBindTexture(GL_TEXTURE_2D, TexStream_Texture(&stream, handles[i]));
+            glDrawArrays(GL_TRIANGLES, i * 6, 6);
+        }
+
+        ++frame;
+        glfwPollEvents();
+        glfwSwapBuffers(window);
+    }
+
+    printf("Texture streaming: %.2f of %.2f MB resident, %d level uploads, %d evictions over %d frames\n",
+           stream.residentBytes / 1048576.0, stream.budget / 1048576.0, stream.uploadCount, stream.evictionCount, frame);
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &vbo);
+    glDeleteProgram(program);
+    TexStream_Free(&stream);
+}
+
+// Three tinted copies of graphite.jpg as layers of one array texture, drawn in one
+// call; each quad's vertices carry the layer they sample.
+void ArrayExample(GLFWwindow* window)
+{
+    enum { LayerCount = 3 };
+    Image layers[LayerCount];
+    for (int layer = 0; layer < LayerCount; ++layer)
+    {
+        assert(Image_Load("graphite.jpg", IMAGE_FLAG_SRGB | IMAGE_FLAG_MIPMAPS, layers + layer));
+        // Every level is tinted, so the tint holds at any distance.
+        Image* image = layers + layer;
+        for (size_t i = 0; i < image->dataSize; ++i)
+        {
+            if ((int)(i % image->channelCount) != layer && (int)(i % image->channelCount) < 3)
+            {
+                image->data[i] /= 2;
+            }
+        }
+    }
+    GLuint texture = Image_CreateTextureArray(layers, LayerCount);
+    assert(texture);
+    for (int layer = 0; layer < LayerCount; ++layer)
+    {
+        Image_Free(layers + layer);
+    }
+
+    // Position (3 floats), UV (2 floats) and layer (1 float) per vertex.
+    float vertices[LayerCount * 6 * 6];
+    for (int layer = 0; layer < LayerCount; ++layer)
+    {
+        float x0 = -0.95f + layer * 0.65f;
+        float x1 = x0 + 0.6f;
+        float corners[6][4] =
+        {
+            {x0, -0.4f, 0.0f, 0.0f},
+            {x1, -0.4f, 1.0f, 0.0f},
+            {x1,  0.4f, 1.0f, 1.0f},
+            {x0, -0.4f, 0.0f, 0.0f},
+            {x1,  0.4f, 1.0f, 1.0f},
+            {x0,  0.4f, 0.0f, 1.0f},
+        };
+        for (int i = 0; i < 6; ++i)
+        {
+            float* v = vertices + (layer * 6 + i) * 6;
+            v[0] = corners[i][0];
+            v[1] = corners[i][1];
+            v[2] = 0.0f;
+            v[3] = corners[i][2];
+            v[4] = corners[i][3];
+            v[5] = (float)layer;
+        }
+    }
+
+    GLuint vao, vbo;
     glGenVertexArrays(1, &vao);
     glBindVertexArray(vao);
-    
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 5, (void*)0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 5, (void*)(sizeof(float) * 3));
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
     glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(5 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+
+    ProgCache programs;
+    ProgCache_Init(&programs, "shadercache");
+    GLuint program = BuildProgram(&programs, "texture_array.vert", "texture_array.frag", window);
+    ProgCache_Report(&programs);
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "uTextures"), 0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+
+    while (!glfwWindowShouldClose(window))
+    {
+        glClearColor(0.25f, 0.25f, 0.25f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        glDrawArrays(GL_TRIANGLES, 0, LayerCount * 6);
+
+        glfwPollEvents();
+        glfwSwapBuffers(window);
+    }
+
+    glDeleteTextures(1, &texture);
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &vbo);
+    glDeleteProgram(program);
+}
+
+// ex-1: Make sure only the happy face looks in the other/reverse direction by changing the fragment shader.
+void TextureExample(GLFWwindow* window)
+{
+    float vertices[] = 
+    {
+        -0.5f, 0.0f, 0.0f, /* */ 0.0f, 0.0f, 
+         0.5f, 0.0f, 0.0f, /* */ 1.0f, 0.0f, 
+         0.0f, 1.0f, 0.0f, /* */ 0.5f, 1.0f, 
+    };
+
+    // Stored as half float positions and 16-bit normalized UVs: 12 bytes a vertex instead of 20.
+    VertexElement elements[] =
+    {
+        {0, 3, VertexEncoding_Half},
+        {1, 2, VertexEncoding_Unorm16},
+    };
+    VertexFormat format;
+    VertexFormat_Init(&format, elements, ArraySize(elements));
+    unsigned char packedVertices[sizeof(vertices)];
+    int vertexCount = (int)(ArraySize(vertices) / format.sourceComponentCount);
+    VertexFormat_Pack(&format, vertices, vertexCount, packedVertices);
+
+    // Decoding, mip generation and block compression run on the loader threads; the
+    // vertex buffer and texture are then created on the uploader's hidden shared context,
+    // each as soon as its data is ready. Frames start right away and draw once both are.
+    // After the first run the cooked copy in texcache/ is mapped instead.
+    Loader* loader = Loader_Create(2);
+    assert(loader);
+    Uploader* uploader = Uploader_Create(window, loader);
+    assert(uploader);
+
+    UploadJob vertexUpload = {.type = UploadType_Buffer, .target = GL_ARRAY_BUFFER, .data = packedVertices,
+                              .size = (GLsizeiptr)vertexCount * format.vertexSize, .usage = GL_STATIC_DRAW};
+    Uploader_Submit(uploader, &vertexUpload);
+
+    ImageJob graphite = {.fileName = "graphite.jpg", .flags = IMAGE_FLAG_SRGB | IMAGE_FLAG_MIPMAPS, .cacheDir = "texcache"};
+    if (Bcn_IsSupported(ImageFormat_BC1))
+    {
+        graphite.format = ImageFormat_BC1;
+        graphite.quality = BcnQuality_Normal;
+    }
+    UploadJob graphiteUpload = {.type = UploadType_Texture, .image = graphite};
+    Uploader_Submit(uploader, &graphiteUpload);
+
+    // The same file under another path, as a second material naming it would load it;
+    // the registry below keeps one texture for both.
+    UploadJob duplicateUpload = {.type = UploadType_Texture, .image = graphite};
+    duplicateUpload.image.fileName = "./graphite.jpg";
+    Uploader_Submit(uploader, &duplicateUpload);
+
+    // Linked binaries from earlier runs in shadercache/ skip compilation entirely.
+    ProgCache programs;
+    ProgCache_Init(&programs, "shadercache");
+    GLuint program = BuildProgram(&programs, "texture.vert", "texture.frag", window);
+
+    glUseProgram(program);
+
+    // The sampler reads texture unit 0.
+    ProgramInfo info;
+    ProgramInfo_Init(&info, program);
+    ProgramInfo_SetInt(&info, ProgramInfo_Uniform(&info, "uTexture"), 0);
+
+    // Loads resolving to the same source or pixels share one texture.
+    TexRegistry textures;
+    TexRegistry_Init(&textures);
+    GLuint texture = 0;
+    GLuint duplicate = 0;
+    GLuint vao = 0;
 
     while (!glfwWindowShouldClose(window))
     {
+        // Vertex arrays are not shared between contexts, so the VAO is built here.
+        if (!vao && Uploader_IsReady(uploader, &vertexUpload))
+        {
+            assert(vertexUpload.success);
+            glGenVertexArrays(1, &vao);
+            glBindVertexArray(vao);
+            glBindBuffer(GL_ARRAY_BUFFER, vertexUpload.name);
+
+            GLint locations[] = {ProgramInfo_Attribute(&info, "inPosition"), ProgramInfo_Attribute(&info, "inTextCoord")};
+            VertexFormat_Apply(&format, locations);
+        }
+        if (!texture && Uploader_IsReady(uploader, &graphiteUpload))
+        {
+            assert(graphiteUpload.success);
+            const ImageJob* job = &graphiteUpload.image;
+            texture = TexRegistry_Adopt(&textures, graphiteUpload.name, (size_t)graphiteUpload.size,
+                                        job->sourceHash, job->pixelHash);
+            glBindTexture(GL_TEXTURE_2D, texture);
+        }
+        if (!duplicate && Uploader_IsReady(uploader, &duplicateUpload))
+        {
+            assert(duplicateUpload.success);
+            const ImageJob* job = &duplicateUpload.image;
+            duplicate = TexRegistry_Adopt(&textures, duplicateUpload.name, (size_t)duplicateUpload.size,
+                                          job->sourceHash, job->pixelHash);
+        }
+
         glClear(GL_COLOR_BUFFER_BIT);
         glClearColor(0.25f, 0.25f, 0.25f, 1.0f);
 
-        glDrawArrays(GL_TRIANGLES, 0, 3);
+        if (vao && texture)
+        {
+            glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+        }
 
         glfwPollEvents();
         glfwSwapBuffers(window);
     }
 
+    ProgCache_Report(&programs);
+    ProgramInfo_Free(&info);
+    printf("Texture dedup: %d shared, %zu bytes of VRAM saved\n",
+           textures.sourceMatchCount + textures.pixelMatchCount, TexRegistry_SavedBytes(&textures));
+    TexRegistry_Release(&textures, texture);
+    TexRegistry_Release(&textures, duplicate);
+    TexRegistry_Free(&textures);
+    Uploader_Destroy(uploader);
+    Loader_Destroy(loader);
+}
+
+int main(int argc, char** argv)
+{
+    // Shaders are compiled in by build-mac.sh; SHADERS_FROM_DISK=1 reads the files instead.
+    ShaderFiles_Register(embeddedShaders, EMBEDDED_SHADER_COUNT);
+    // Shader build times are printed at exit, or written as JSON to $SHADER_STATS_JSON.
+    ShaderStats_ReportAtExit(getenv("SHADER_STATS_JSON"));
+    assert(glfwInit());
+    GLFWwindow* window = Utils_CreateWindow("Textures exercises");
+    assert(window);
+    assert(gladLoadGLLoader((GLADloadproc)glfwGetProcAddress));
+
+    glfwSetFramebufferSizeCallback(window, FrameBufferSizeCallback);
+    glfwSetKeyCallback(window, KeyCallback);
+
+    // ./textures.out atlas, stream or array runs that example; no argument runs the exercise.
+    const char* example = argc > 1 ? argv[1] : "";
+    if (strcmp(example, "atlas") == 0)
+    {
+        AtlasExample(window);
+    }
+    else if (strcmp(example, "stream") == 0)
+    {
+        StreamingExample(window);
+    }
+    else if (strcmp(example, "array") == 0)
+    {
+        ArrayExample(window);
+    }
+    else
+    {
+        TextureExample(window);
+    }
+
     glfwDestroyWindow(window);
     glfwTerminate();
-
 }
\ No newline at end of file
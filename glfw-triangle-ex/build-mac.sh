@@ -4,4 +4,8 @@ INCLUDES="-I../include"
 LINKER_FLAGS="-L../libs -lglfw3 -framework OpenGL -framework Cocoa -framework IOkit -framework CoreVideo"
 SOURCES="*.c ../src/*/*.c"
 
+# Compiles the shaders in as string tables; see utils/shaderfiles.h.
+clang ../tools/embed_shaders.c ../src/utils/hash.c $INCLUDES -O2 -o embed_shaders.out || exit 1
+./embed_shaders.out *.vert *.frag > embedded_shaders.h || exit 1
+
 clang $SOURCES $INCLUDES $LINKER_FLAGS -Wall -g -o main.out
\ No newline at end of file
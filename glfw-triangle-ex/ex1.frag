@@ -1,7 +1,12 @@
 #version 330 core
 out vec4 FragColor;
 
+// Variants override the colour with a COLOR define.
+#ifndef COLOR
+#define COLOR vec4(1.0f, 0.5f, 0.2f, 0.75f)
+#endif
+
 void main()
 {
-    FragColor = vec4(1.0f, 0.5f, 0.2f, 0.75f);
+    FragColor = COLOR;
 }
\ No newline at end of file
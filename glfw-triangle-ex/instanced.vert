@@ -0,0 +1,13 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+// Per instance, through glVertexAttribDivisor.
+layout (location = 1) in vec2 aOffset;
+layout (location = 2) in vec4 aColor;
+
+out vec4 color;
+
+void main()
+{
+    gl_Position = vec4(aPos.xy + aOffset, aPos.z, 1.0);
+    color = aColor;
+}
\ No newline at end of file
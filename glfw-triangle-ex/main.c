@@ -1,14 +1,25 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include "utils/utils.h"
+#include "utils/progcache.h"
+#include "utils/shaderbatch.h"
+#include "utils/shadervariants.h"
+#include "utils/shaderfiles.h"
+#include "utils/shaderstats.h"
+#include "utils/meshpool.h"
+#include "utils/instances.h"
+#include "utils/meshopt.h"
+#include "embedded_shaders.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
 
 typedef GLuint Shader;
 typedef GLuint Program;
 typedef GLuint VAO;
 typedef GLuint VBO;
-typedef GLuint EBO;
+typedef int Mesh;
 
 
 // TODO: switch to makefiles
@@ -27,15 +38,6 @@ void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods
     }
 }
 
-EBO CreateEBO(unsigned int *indices, unsigned int indexCount)
-{
-    EBO result;
-    glGenBuffers(1, &result);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, result);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(unsigned int), indices, GL_STATIC_DRAW);
-    return result;
-}
-
 VBO CreateVBO(float* vertices, unsigned int vertexCount)
 {
     VBO result;
@@ -52,21 +54,44 @@ VAO CreateVAO()
     return result;
 }
 
-Shader CreateShader(GLenum shaderType, const char* source)
+// Positions only; every mesh shares the pool's few buffers and VAOs instead of owning a VBO and EBO.
+void CreateMeshPool(MeshPool* pool)
 {
-    Shader result = glCreateShader(shaderType);
-    glShaderSource(result, 1, &source, NULL);
-    glCompileShader(result);
+    MeshAttribute position = {0, 3, GL_FLOAT, GL_FALSE, 0};
+    MeshPool_Init(pool, 3 * sizeof(float), &position, 1, 1 << 16, 3 << 16);
+}
+
+// Reorders copies of the data for the vertex cache, overdraw and vertex fetch before
+// upload, so the caller's arrays can be shared between meshes.
+Mesh CreateMesh(MeshPool* pool, float* vertices, unsigned int vertexCount, unsigned int* indices, unsigned int indexCount)
+{
+    float* optimizedVertices = malloc(vertexCount * sizeof(float));
+    unsigned int* optimizedIndices = malloc(indexCount * sizeof(unsigned int));
+    memcpy(optimizedVertices, vertices, vertexCount * sizeof(float));
+    memcpy(optimizedIndices, indices, indexCount * sizeof(unsigned int));
+
+    MeshOptStats stats;
+    int optimizedCount = MeshOpt_Optimize(optimizedVertices, vertexCount / 3, 3 * sizeof(float), optimizedIndices,
+                                          indexCount, &stats);
+    MeshOpt_Report("triangles", &stats);
+    Mesh result = MeshPool_Add(pool, optimizedVertices, optimizedCount, optimizedIndices, indexCount);
+
+    free(optimizedVertices);
+    free(optimizedIndices);
     return result;
 }
 
-Shader CreateShaderProgram(Shader vertex, Shader fragment)
+// Compiles and links, or loads the linked binary a previous run left in the cache.
+Program CreateShaderProgram(ProgCache* cache, const char* name, const char* vertexSource, const char* fragmentSource,
+                            GLFWwindow* window)
 {
-    Program program = glCreateProgram();
-    glAttachShader(program, vertex);
-    glAttachShader(program, fragment);
-    glLinkProgram(program);
-    return program;
+    return ProgCache_Build(cache, name, vertexSource, fragmentSource, window);
+}
+
+void ShaderError(const char* name, const char* stage, const char* log, void* userData)
+{
+    ShaderBatch_PrintError(name, stage, log, NULL);
+    glfwSetWindowShouldClose((GLFWwindow*)userData, GLFW_TRUE);
 }
 
 void _SafeFree(void* memory)
@@ -97,27 +122,20 @@ void FirstSolution(GLFWwindow* window)
         1, 3, 4
     };
 
-    VBO vbo = CreateVBO(vertices, ArraySize(vertices));
-
-    VAO vao = CreateVAO();
-    glBindVertexArray(vao);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    EBO ebo = CreateEBO(indices, ArraySize(indices));
+    MeshPool meshes;
+    CreateMeshPool(&meshes);
+    Mesh mesh = CreateMesh(&meshes, vertices, ArraySize(vertices), indices, ArraySize(indices));
 
     while (!glfwWindowShouldClose(window))
     {
         glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+        MeshPool_Draw(&meshes, mesh);
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
 
-    glDeleteBuffers(1, &ebo);
-    glDeleteBuffers(1, &vbo);
-    glDeleteVertexArrays(1, &vao);
+    MeshPool_Free(&meshes);
 }
 
 // 2. Now create the same 2 triangles using two different VAOs and VBOs for their data.
@@ -187,25 +205,20 @@ void FirstAndSecondSolutionSetup()
 
         if (gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
         {
-            const char* vertexShaderSource = Utils_ReadTextFile("ex1.vert");
-            const char* fragmentShaderSource = Utils_ReadTextFile("ex1.frag");
+            const char* vertexShaderSource = ShaderFiles_Read("ex1.vert");
+            const char* fragmentShaderSource = ShaderFiles_Read("ex1.frag");
 
             if (fragmentShaderSource && vertexShaderSource)
             {
-                
-                Shader vertex = CreateShader(GL_VERTEX_SHADER, vertexShaderSource);
-                Utils_CheckShaderState(vertex, window);
-                Shader fragment = CreateShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
-                Utils_CheckShaderState(fragment, window);
-                Program program = CreateShaderProgram(vertex, fragment);
-                Utils_CheckProgramState(program, window);
+                ProgCache programs;
+                ProgCache_Init(&programs, "shadercache");
+                Program program = CreateShaderProgram(&programs, "ex1", vertexShaderSource, fragmentShaderSource, window);
+                ProgCache_Report(&programs);
                 glUseProgram(program);
 
                 SecondSolution(window);
 
                 glDeleteProgram(program);
-                glDeleteShader(vertex);
-                glDeleteShader(fragment);
 
                 SafeFree(vertexShaderSource);
                 SafeFree(fragmentShaderSource);
@@ -232,27 +245,28 @@ void ThirdSolution()
 
         if (gladLoadGLLoader(glfwGetProcAddress))
         {
-            const char* vertexShdrSrc = Utils_ReadTextFile("ex1.vert");
-            const char* fragmentShdrSrcA = Utils_ReadTextFile("ex1.frag");
-            const char* fragmentShdrSrcB = Utils_ReadTextFile("ex3.frag");
+            const char* vertexShdrSrc = ShaderFiles_Read("ex1.vert");
+            const char* fragmentShdrSrc = ShaderFiles_Read("ex1.frag");
 
-            int shadersLoaded = vertexShdrSrc && fragmentShdrSrcA && fragmentShdrSrcB;
+            int shadersLoaded = vertexShdrSrc && fragmentShdrSrc;
 
             if (shadersLoaded)
             {
-                Shader vert = CreateShader(GL_VERTEX_SHADER, vertexShdrSrc);
-                Shader fragOrange = CreateShader(GL_FRAGMENT_SHADER, fragmentShdrSrcA);
-                Shader fragYellow = CreateShader(GL_FRAGMENT_SHADER, fragmentShdrSrcB);
-
-                Utils_CheckShaderState(vert, window);
-                Utils_CheckShaderState(fragOrange, window);
-                Utils_CheckShaderState(fragYellow, window);
-
-                Program programOrange = CreateShaderProgram(vert, fragOrange);
-                Program programYellow = CreateShaderProgram(vert, fragYellow);
-
-                Utils_CheckProgramState(programOrange, window);
-                Utils_CheckProgramState(programYellow, window);
+                // One fragment shader, two colours: the yellow one is a COLOR define away.
+                // Both variants compile while the first frames are drawn; each triangle
+                // appears once its program is ready.
+                ProgCache programs;
+                ProgCache_Init(&programs, "shadercache");
+                ShaderVariants variants;
+                ShaderVariants_Init(&variants, "ex1", vertexShdrSrc, fragmentShdrSrc, &programs, ShaderError, window);
+                int orange = ShaderVariants_Declare(&variants, "");
+                int yellow = ShaderVariants_Declare(&variants, "COLOR=vec4(1.0f, 1.0f, 0.0f, 1.0f)");
+                ShaderVariants_Precompile(&variants);
+
+                // Both triangles share one buffer pair and VAO, drawn at their own base vertex.
+                MeshPool meshes;
+                CreateMeshPool(&meshes);
+                unsigned int indices[] = {0, 1, 2};
 
                 float verticesA[] =
                 {
@@ -260,12 +274,7 @@ void ThirdSolution()
                          0.0f, -0.5f, 0.0f,    
                         -0.5,   0.5f, 0.0f
                 };
-                VBO vboA = CreateVBO(verticesA, ArraySize(verticesA));
-
-                VAO vaoA = CreateVAO();
-                glBindVertexArray(vaoA);
-                glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-                glEnableVertexAttribArray(0);
+                Mesh meshA = CreateMesh(&meshes, verticesA, ArraySize(verticesA), indices, ArraySize(indices));
 
                 float verticesB[] =
                 {
@@ -273,31 +282,123 @@ void ThirdSolution()
                         1.0f, -0.5f, 0.0f,  
                         0.5f,  0.5f, 0.0f
                 };
+                Mesh meshB = CreateMesh(&meshes, verticesB, ArraySize(verticesB), indices, ArraySize(indices));
+
+                while (!glfwWindowShouldClose(window))
+                {
+                    ShaderVariants_Poll(&variants);
+                    Program programOrange = ShaderVariants_Program(&variants, orange);
+                    Program programYellow = ShaderVariants_Program(&variants, yellow);
+
+                    glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+                    glClear(GL_COLOR_BUFFER_BIT);
 
-                VBO vboB = CreateVBO(verticesB, ArraySize(verticesB));
+                    if (programOrange)
+                    {
+                        glUseProgram(programOrange);
+                        MeshPool_Draw(&meshes, meshA);
+                    }
 
-                VAO vaoB = CreateVAO();
-                glBindVertexArray(vaoB);
-                glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-                glEnableVertexAttribArray(0);
+                    if (programYellow)
+                    {
+                        glUseProgram(programYellow);
+                        MeshPool_Draw(&meshes, meshB);
+                    }
 
+                    glfwPollEvents();
+                    glfwSwapBuffers(window);
+                }
+
+                ProgCache_Report(&programs);
+                MeshPool_Report(&meshes);
+                MeshPool_Free(&meshes);
+                ShaderVariants_Free(&variants);
+            }
+        }
+        glfwDestroyWindow(window);
+    }
+    glfwTerminate();
+}
+
+typedef struct
+{
+    float offset[2];
+    float color[4];
+} TriangleInstance;
+
+// ex-3 again with one draw call: the second triangle is an instance of the first,
+// moved right and coloured yellow by its per-instance attributes.
+void InstancedSolution()
+{
+    if (!glfwInit())
+    {
+        exit(1);
+    }
+
+    GLFWwindow* window = Utils_CreateWindow("Solution - 3, instanced");
+    if (window)
+    {
+        glfwSetKeyCallback(window, KeyCallback);
+        glfwSetFramebufferSizeCallback(window, FrameBufferSizeCallback);
+
+        if (gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+        {
+            const char* vertexShdrSrc = ShaderFiles_Read("instanced.vert");
+            const char* fragmentShdrSrc = ShaderFiles_Read("instanced.frag");
+
+            if (vertexShdrSrc && fragmentShdrSrc)
+            {
+                ProgCache programs;
+                ProgCache_Init(&programs, "shadercache");
+                Program program = CreateShaderProgram(&programs, "instanced", vertexShdrSrc, fragmentShdrSrc, window);
+                ProgCache_Report(&programs);
+
+                MeshPool meshes;
+                CreateMeshPool(&meshes);
+                float vertices[] =
+                {
+                        -1.0f, -0.5f, 0.0f,
+                         0.0f, -0.5f, 0.0f,
+                        -0.5,   0.5f, 0.0f
+                };
+                unsigned int indices[] = {0, 1, 2};
+                Mesh triangle = CreateMesh(&meshes, vertices, ArraySize(vertices), indices, ArraySize(indices));
+
+                MeshAttribute instanceAttributes[] =
+                {
+                    {1, 2, GL_FLOAT, GL_FALSE, offsetof(TriangleInstance, offset)},
+                    {2, 4, GL_FLOAT, GL_FALSE, offsetof(TriangleInstance, color)},
+                };
+                TriangleInstance triangles[] =
+                {
+                    {{0.0f, 0.0f}, {1.0f, 0.5f, 0.2f, 0.75f}},
+                    {{1.0f, 0.0f}, {1.0f, 1.0f, 0.0f, 1.0f}},
+                };
+                InstanceBuffer instances;
+                InstanceBuffer_Init(&instances, sizeof(TriangleInstance), instanceAttributes,
+                                    ArraySize(instanceAttributes), ArraySize(triangles));
+                InstanceBuffer_Update(&instances, triangles, ArraySize(triangles));
+                InstanceBuffer_AttachPool(&instances, &meshes);
+
+                glUseProgram(program);
                 while (!glfwWindowShouldClose(window))
                 {
                     glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
                     glClear(GL_COLOR_BUFFER_BIT);
 
-                    glBindVertexArray(vaoA);
-                    glUseProgram(programOrange);
-                    glDrawArrays(GL_TRIANGLES, 0, 3);
-
-                    glBindVertexArray(vaoB);
-                    glUseProgram(programYellow);
-                    glDrawArrays(GL_TRIANGLES, 0, 3);
+                    MeshPool_DrawInstanced(&meshes, triangle, instances.instanceCount);
 
                     glfwPollEvents();
                     glfwSwapBuffers(window);
                 }
+
+                MeshPool_Report(&meshes);
+                InstanceBuffer_Free(&instances);
+                MeshPool_Free(&meshes);
+                glDeleteProgram(program);
             }
+            SafeFree(vertexShdrSrc);
+            SafeFree(fragmentShdrSrc);
         }
         glfwDestroyWindow(window);
     }
@@ -306,6 +407,11 @@ void ThirdSolution()
 
 int main()
 {
+    // Shaders are compiled in by build-mac.sh; SHADERS_FROM_DISK=1 reads the files instead.
+    ShaderFiles_Register(embeddedShaders, EMBEDDED_SHADER_COUNT);
+    // Shader build times are printed at exit, or written as JSON to $SHADER_STATS_JSON.
+    ShaderStats_ReportAtExit(getenv("SHADER_STATS_JSON"));
     // FirstAndSecondSolutionSetup();
+    // InstancedSolution();
     ThirdSolution();
 }
\ No newline at end of file
@@ -0,0 +1,8 @@
+#!/bin/sh
+
+# For Mesa's llvmpipe run with LIBGL_ALWAYS_SOFTWARE=1 ./upload_bench.out
+INCLUDES="-I../include"
+LINKER_FLAGS="-lglfw -lGL -lpthread -ldl -lm"
+SOURCES="*.c ../src/*/*.c"
+
+cc $SOURCES $INCLUDES $LINKER_FLAGS -Wall -O2 -o upload_bench.out
@@ -0,0 +1,133 @@
+#include "glad/glad.h"
+#include "GLFW/glfw3.h"
+#include "utils/utils.h"
+#include "utils/glext.h"
+#include "utils/hash.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+// Measures texture upload throughput for the layouts the texture path can choose between,
+// and how fast the loader's hashes get through pixel data.
+// On Linux, LIBGL_ALWAYS_SOFTWARE=1 runs it on Mesa's llvmpipe.
+
+#define ITERATIONS 32
+
+typedef struct
+{
+    const char* name;
+    int channelCount;
+    int immutable;
+} UploadCase;
+
+static double MeasureUploads(const UploadCase* upload, int width, int height, const unsigned char* pixels)
+{
+    const GLExtensions* extensions = GLExt_Get();
+    GLenum format = upload->channelCount == 4 ? GL_RGBA : GL_RGB;
+    GLenum internalFormat = upload->channelCount == 4 ? GL_RGBA8 : GL_RGB8;
+    size_t pitch = (size_t)width * upload->channelCount;
+
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    if (upload->immutable)
+    {
+        extensions->TexStorage2D(GL_TEXTURE_2D, 1, internalFormat, width, height);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, pitch % 4 == 0 ? 4 : 1);
+
+    glFinish();
+    double start = glfwGetTime();
+    for (int i = 0; i < ITERATIONS; ++i)
+    {
+        if (upload->immutable)
+        {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, format, GL_UNSIGNED_BYTE, pixels);
+        }
+        else
+        {
+            glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, GL_UNSIGNED_BYTE, pixels);
+        }
+    }
+    glFinish();
+    double elapsed = glfwGetTime() - start;
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glDeleteTextures(1, &texture);
+
+    double megabytes = (double)pitch * height * ITERATIONS / (1024.0 * 1024.0);
+    return megabytes / elapsed;
+}
+
+// Returns MB/s hashing size bytes, repeated until at least 256 MB have been hashed.
+static double MeasureHash(uint64_t (*hash)(const void*, size_t, uint64_t), const unsigned char* data, size_t size)
+{
+    int repeats = (int)((256u << 20) / size);
+    // Summed so the calls cannot be dropped.
+    volatile uint64_t sum = hash(data, size, 0);
+    double start = glfwGetTime();
+    for (int i = 0; i < repeats; ++i)
+    {
+        sum += hash(data, size, (uint64_t)i);
+    }
+    double elapsed = glfwGetTime() - start;
+    (void)sum;
+    return (double)size * repeats / (1024.0 * 1024.0) / elapsed;
+}
+
+int main()
+{
+    assert(glfwInit());
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* window = Utils_CreateWindow("Upload benchmark");
+    assert(window);
+    assert(gladLoadGLLoader((GLADloadproc)glfwGetProcAddress));
+
+    printf("%s | %s\n", glGetString(GL_RENDERER), glGetString(GL_VERSION));
+
+    const GLExtensions* extensions = GLExt_Get();
+    UploadCase cases[] =
+    {
+        {"RGB  glTexImage2D", 3, 0},
+        {"RGB  glTexStorage2D", 3, 1},
+        {"RGBA glTexImage2D", 4, 0},
+        {"RGBA glTexStorage2D", 4, 1},
+    };
+    int sizes[][2] = {{1024, 1024}, {1023, 1023}, {2048, 2048}};
+
+    unsigned char* pixels = malloc(2048 * 2048 * 4);
+    assert(pixels);
+    for (int i = 0; i < 2048 * 2048 * 4; ++i)
+    {
+        pixels[i] = (unsigned char)(i * 31);
+    }
+
+    for (int s = 0; s < (int)ArraySize(sizes); ++s)
+    {
+        for (int c = 0; c < (int)ArraySize(cases); ++c)
+        {
+            if (cases[c].immutable && !extensions->textureStorage)
+            {
+                continue;
+            }
+            double throughput = MeasureUploads(cases + c, sizes[s][0], sizes[s][1], pixels);
+            printf("%4dx%-4d %-22s %8.1f MB/s\n", sizes[s][0], sizes[s][1], cases[c].name, throughput);
+        }
+    }
+
+    // Image_HashPixels runs Hash_Wide over every decoded level; source files go through Hash_Bytes.
+    size_t hashSizes[] = {256 << 10, 16 << 20};
+    printf("\n%-10s %14s %14s\n", "hashed", "Hash_Bytes", "Hash_Wide");
+    for (int s = 0; s < (int)ArraySize(hashSizes); ++s)
+    {
+        double bytesSpeed = MeasureHash(Hash_Bytes, pixels, hashSizes[s]);
+        double wideSpeed = MeasureHash(Hash_Wide, pixels, hashSizes[s]);
+        printf("%7zu KB %9.0f MB/s %9.0f MB/s\n", hashSizes[s] >> 10, bytesSpeed, wideSpeed);
+    }
+
+    free(pixels);
+    glfwDestroyWindow(window);
+    glfwTerminate();
+}
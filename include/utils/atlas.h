@@ -0,0 +1,54 @@
+#ifndef ATLAS_H
+#define ATLAS_H
+
+#include "utils/image.h"
+
+#define ATLAS_MAX_PAGES 8
+
+typedef struct
+{
+    int x;
+    int y;
+    int width;
+} SkylineNode;
+
+typedef struct
+{
+    SkylineNode* nodes;
+    int nodeCount;
+    int nodeCapacity;
+} Skyline;
+
+// Where an added image ended up; UVs address the unpadded pixels.
+typedef struct
+{
+    int page;
+    float u0;
+    float v0;
+    float u1;
+    float v1;
+} AtlasRect;
+
+// Images are packed into RGBA pages with a skyline bottom-left packer. Every rect
+// gets an extruded gutter of `padding` texels and starts on a multiple of it, so
+// box filtered mips down to log2(padding) never mix neighbouring images.
+typedef struct
+{
+    int pageSize;
+    int padding;
+    int levelCount;
+    int flags;
+    int pageCount;
+    Image pages[ATLAS_MAX_PAGES];
+    Skyline skylines[ATLAS_MAX_PAGES];
+} Atlas;
+
+void Atlas_Init(Atlas* atlas, int pageSize, int padding, int flags);
+void Atlas_Free(Atlas* atlas);
+int Atlas_Add(Atlas* atlas, const Image* image, AtlasRect* rect);
+int Atlas_AddBatch(Atlas* atlas, const Image* images, int count, AtlasRect* rects);
+int Atlas_Finish(Atlas* atlas);
+GLuint Atlas_CreateTexture(const Atlas* atlas, int page);
+void Atlas_WriteQuad(const AtlasRect* rect, float x0, float y0, float x1, float y1, float* vertices);
+
+#endif
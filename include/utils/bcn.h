@@ -0,0 +1,38 @@
+#ifndef BCN_H
+#define BCN_H
+
+#include "utils/image.h"
+
+// S3TC is an extension on desktop GL, so glad's core 3.3 header does not carry these.
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+typedef enum
+{
+    // Bounding box endpoints.
+    BcnQuality_Fast,
+    // Endpoints along the principal axis of the block.
+    BcnQuality_Normal,
+    // Principal axis plus least squares endpoint refinement and BC4 six-value mode.
+    BcnQuality_High
+} BcnQuality;
+
+ImageFormat Bcn_FormatForChannels(int channelCount);
+int Bcn_IsSupported(ImageFormat format);
+GLenum Bcn_GLFormat(ImageFormat format);
+size_t Bcn_LevelSize(ImageFormat format, int width, int height);
+
+void Bcn_CompressLevel(ImageFormat format, BcnQuality quality,
+                       const unsigned char* pixels, int width, int height, int channelCount,
+                       unsigned char* blocks, int threadCount);
+void Bcn_DecompressLevel(ImageFormat format, const unsigned char* blocks,
+                         int width, int height, unsigned char* rgba);
+
+int Bcn_CompressImage(Image* image, ImageFormat format, BcnQuality quality, int threadCount);
+double Bcn_ComputePsnr(const Image* original, const Image* compressed, int level);
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef GLEXT_H
+#define GLEXT_H
+
+#include <glad/glad.h>
+
+#ifndef GL_TEXTURE_IMMUTABLE_FORMAT
+#define GL_TEXTURE_IMMUTABLE_FORMAT 0x912F
+#endif
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+typedef void (APIENTRYP GLExtTexStorage2DProc)(GLenum target, GLsizei levels, GLenum internalFormat,
+                                               GLsizei width, GLsizei height);
+typedef void (APIENTRYP GLExtTexStorage3DProc)(GLenum target, GLsizei levels, GLenum internalFormat,
+                                               GLsizei width, GLsizei height, GLsizei depth);
+typedef void (APIENTRYP GLExtGetProgramBinaryProc)(GLuint program, GLsizei bufSize, GLsizei* length,
+                                                   GLenum* binaryFormat, void* binary);
+typedef void (APIENTRYP GLExtProgramBinaryProc)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+typedef void (APIENTRYP GLExtProgramParameteriProc)(GLuint program, GLenum pname, GLint value);
+typedef void (APIENTRYP GLExtMaxShaderCompilerThreadsProc)(GLuint count);
+
+// Entry points beyond glad's core 3.3 profile. A feature flag is set only when
+// every function it needs was found.
+typedef struct
+{
+    int textureStorage;
+    GLExtTexStorage2DProc TexStorage2D;
+    GLExtTexStorage3DProc TexStorage3D;
+    // Also requires the driver to offer at least one binary format.
+    int programBinary;
+    GLExtGetProgramBinaryProc GetProgramBinary;
+    GLExtProgramBinaryProc ProgramBinary;
+    GLExtProgramParameteriProc ProgramParameteri;
+    // KHR or ARB_parallel_shader_compile: GL_COMPLETION_STATUS_KHR can be polled.
+    int parallelShaderCompile;
+    GLExtMaxShaderCompilerThreadsProc MaxShaderCompilerThreads;
+} GLExtensions;
+
+// Resolves entry points for contexts not created through GLFW, e.g. eglGetProcAddress.
+typedef void* (*GLExtLoadProc)(const char* name);
+
+// Loads on first use; needs a current context.
+const GLExtensions* GLExt_Get(void);
+void GLExt_SetLoader(GLExtLoadProc load);
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+uint64_t Hash_Bytes(const void* data, size_t size, uint64_t seed);
+uint64_t Hash_String(const char* text, uint64_t seed);
+// Faster on large buffers such as decoded pixels; a different function from Hash_Bytes.
+uint64_t Hash_Wide(const void* data, size_t size, uint64_t seed);
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef HOTRELOAD_H
+#define HOTRELOAD_H
+
+#include "utils/shaderbatch.h"
+#include "utils/preprocessor.h"
+#include "utils/programinfo.h"
+
+typedef struct
+{
+    char* paths[2];
+    // Both paths, for error reports.
+    char* name;
+    // Watch descriptors on Linux, modification times elsewhere.
+    int watches[2];
+    long long mtimes[2];
+    GLuint program;
+    // Bumped on every swap; uniforms have to be looked up and set again on the new program.
+    int generation;
+    ProgramInfo info;
+    int dirty;
+    int building;
+    ShaderBatch batch;
+} ReloadProgram;
+
+// Rebuilds programs whose vertex or fragment file changed on disk. Rebuilds compile
+// through a ShaderBatch over the following frames; the program is swapped only once
+// the new one links, so a typo keeps the last good version running. Uses inotify on
+// Linux and polls modification times elsewhere. With a preprocessor, sources are
+// expanded through it and an edit to any included file rebuilds its programs too.
+typedef struct
+{
+    ReloadProgram* programs;
+    int programCount;
+    int programCapacity;
+    int inotifyFd;
+    double lastPollTime;
+    Preprocessor* preprocessor;
+    ShaderErrorFunc onError;
+    void* userData;
+} HotReload;
+
+void HotReload_Init(HotReload* reload, Preprocessor* preprocessor, ShaderErrorFunc onError, void* userData);
+void HotReload_Free(HotReload* reload);
+int HotReload_Add(HotReload* reload, const char* vertPath, const char* fragPath, GLuint program);
+void HotReload_Update(HotReload* reload);
+GLuint HotReload_Program(const HotReload* reload, int handle);
+int HotReload_Generation(const HotReload* reload, int handle);
+ProgramInfo* HotReload_Info(HotReload* reload, int handle);
+
+#endif
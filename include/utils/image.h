@@ -0,0 +1,61 @@
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <glad/glad.h>
+
+#define IMAGE_MAX_LEVELS 16
+
+enum
+{
+    // Pixel data is sRGB encoded; filtering happens in linear space.
+    IMAGE_FLAG_SRGB    = 1 << 0,
+    // Build the full mip chain on the CPU after decoding.
+    IMAGE_FLAG_MIPMAPS = 1 << 1,
+};
+
+typedef enum
+{
+    ImageFormat_Uncompressed,
+    ImageFormat_BC1,
+    ImageFormat_BC3,
+    ImageFormat_BC4,
+    ImageFormat_BC5
+} ImageFormat;
+
+typedef struct
+{
+    int width;
+    int height;
+    size_t offset;
+    size_t size;
+} ImageLevel;
+
+// Every level lives in one tightly packed allocation, level 0 first.
+typedef struct
+{
+    int width;
+    int height;
+    int channelCount;
+    int flags;
+    ImageFormat format;
+    int levelCount;
+    ImageLevel levels[IMAGE_MAX_LEVELS];
+    unsigned char* data;
+    size_t dataSize;
+    // Set when data points into a memory mapped cache file rather than the heap.
+    void* mapping;
+    size_t mappingSize;
+} Image;
+
+int Image_Load(const char* fileName, int flags, Image* image);
+int Image_LoadFromMemory(const unsigned char* bytes, size_t size, int flags, Image* image);
+void Image_Free(Image* image);
+uint64_t Image_HashPixels(const Image* image);
+GLuint Image_CreateTexture(const Image* image);
+void Image_UploadLevels(const Image* image, GLenum target);
+void Image_DefineLevel(const Image* image, GLenum target, int index);
+GLuint Image_CreateTextureArray(const Image* images, int count);
+
+#endif
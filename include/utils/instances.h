@@ -0,0 +1,28 @@
+#ifndef INSTANCES_H
+#define INSTANCES_H
+
+#include "utils/meshpool.h"
+
+// Per-instance attributes (transforms, colours) in one buffer, read once per
+// instance through glVertexAttribDivisor, so N copies of a mesh are one draw call.
+// Attribute locations must not overlap the mesh's; a mat4 takes four vec4 attributes.
+typedef struct
+{
+    GLuint buffer;
+    GLsizei instanceSize;
+    MeshAttribute attributes[MESHPOOL_MAX_ATTRIBUTES];
+    int attributeCount;
+    int capacity;
+    int instanceCount;
+    int uploadCount;
+} InstanceBuffer;
+
+void InstanceBuffer_Init(InstanceBuffer* instances, GLsizei instanceSize, const MeshAttribute* attributes,
+                         int attributeCount, int capacity);
+void InstanceBuffer_Free(InstanceBuffer* instances);
+int InstanceBuffer_Update(InstanceBuffer* instances, const void* data, int count);
+void InstanceBuffer_Attach(const InstanceBuffer* instances, GLuint vao);
+void InstanceBuffer_AttachPool(const InstanceBuffer* instances, MeshPool* pool);
+void InstanceBuffer_DrawArrays(const InstanceBuffer* instances, GLenum mode, GLint first, GLsizei count);
+
+#endif
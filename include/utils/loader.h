@@ -0,0 +1,44 @@
+#ifndef LOADER_H
+#define LOADER_H
+
+#include "utils/image.h"
+#include "utils/bcn.h"
+#include "utils/texcache.h"
+
+typedef struct Loader Loader;
+struct ImageJob;
+
+// Called on the loader thread once the job is done, successful or not.
+typedef void (*ImageJobDoneFunc)(struct ImageJob* job, void* userData);
+
+// Filled in by the caller, completed by a loader thread. Must stay alive until done,
+// and until onDone has returned when it is set.
+typedef struct ImageJob
+{
+    const char* fileName;
+    int flags;
+    // Block compress every level after decoding unless ImageFormat_Uncompressed.
+    ImageFormat format;
+    BcnQuality quality;
+    // Optional directory of cooked textures; when set the image may be memory mapped.
+    const char* cacheDir;
+    // Optional; lets a consumer pick the job up without waiting on it.
+    ImageJobDoneFunc onDone;
+    void* userData;
+    Image image;
+    // Hash of the source bytes and cook options, and Image_HashPixels of the result; see TexRegistry.
+    uint64_t sourceHash;
+    uint64_t pixelHash;
+    int success;
+    int cacheHit;
+    int done;
+    struct ImageJob* next;
+} ImageJob;
+
+Loader* Loader_Create(int threadCount);
+void Loader_Destroy(Loader* loader);
+void Loader_Submit(Loader* loader, ImageJob* job);
+int Loader_IsDone(Loader* loader, ImageJob* job);
+void Loader_Wait(Loader* loader, ImageJob* job);
+
+#endif
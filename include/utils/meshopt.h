@@ -0,0 +1,62 @@
+#ifndef MESHOPT_H
+#define MESHOPT_H
+
+// Post-transform cache size assumed when reordering and when reporting; close to what
+// current GPUs behave like for triangle lists.
+#define MESHOPT_CACHE_SIZE 16
+// How much worse than its best a cluster's cache efficiency may get to let overdraw
+// ordering split it into smaller clusters.
+#define MESHOPT_OVERDRAW_THRESHOLD 1.05f
+
+typedef struct
+{
+    int triangleCount;
+    int vertexCount;
+    int transformedVertices;
+    // Vertex shader runs per triangle: 0.5 at best on a regular grid, 3 at worst.
+    float acmr;
+    // Vertex shader runs per referenced vertex: 1 when each vertex runs once.
+    float atvr;
+    // Bytes read through 64-byte lines per byte of referenced vertex data.
+    float overfetch;
+} MeshCacheStats;
+
+typedef struct
+{
+    MeshCacheStats before;
+    MeshCacheStats after;
+    int clusterCount;
+} MeshOptStats;
+
+// Simulates a FIFO post-transform cache of cacheSize entries over a triangle list.
+void MeshOpt_CacheStats(const unsigned int* indices, int indexCount, int vertexCount, int vertexSize, int cacheSize,
+                        MeshCacheStats* stats);
+
+// Tipsify: fans around the most recently used vertex with triangles left, so each
+// triangle reuses what the previous ones transformed. destination may be indices.
+void MeshOpt_OptimizeCache(unsigned int* destination, const unsigned int* indices, int indexCount, int vertexCount,
+                           int cacheSize);
+
+// Splits a cache-ordered triangle list into clusters that keep most of its cache
+// efficiency, and draws those facing away from the mesh's centre first, so outer
+// surfaces tend to hide inner ones under early depth testing. Positions are the
+// first three floats of each vertex. Returns the number of clusters.
+int MeshOpt_OptimizeOverdraw(unsigned int* indices, int indexCount, const void* vertices, int vertexCount,
+                             int vertexSize, int cacheSize, float threshold);
+
+// Numbers vertices in order of first use, so drawing reads the vertex buffer front to
+// back. Unreferenced vertices are dropped; returns how many remain. remap[old] is the
+// new index, or ~0u for dropped vertices.
+int MeshOpt_FetchRemap(unsigned int* remap, const unsigned int* indices, int indexCount, int vertexCount);
+void MeshOpt_RemapVertices(void* destination, const void* vertices, int vertexCount, int vertexSize,
+                           const unsigned int* remap);
+void MeshOpt_RemapIndices(unsigned int* destination, const unsigned int* indices, int indexCount,
+                          const unsigned int* remap);
+
+// All three passes in place on a triangle list, before handing it to MeshPool_Add or
+// glBufferData. Returns the new vertex count; stats may be NULL.
+int MeshOpt_Optimize(void* vertices, int vertexCount, int vertexSize, unsigned int* indices, int indexCount,
+                     MeshOptStats* stats);
+void MeshOpt_Report(const char* name, const MeshOptStats* stats);
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef MESHPOOL_H
+#define MESHPOOL_H
+
+#include <glad/glad.h>
+#include <stddef.h>
+
+#define MESHPOOL_MAX_PAGES 8
+#define MESHPOOL_MAX_ATTRIBUTES 8
+// TLSF: power-of-two size classes split into 2^MESHPOOL_SL_LOG2 linear steps.
+#define MESHPOOL_FL_COUNT 32
+#define MESHPOOL_SL_LOG2 4
+#define MESHPOOL_SL_COUNT (1 << MESHPOOL_SL_LOG2)
+// Marks a strip or fan restart in the indices given to MeshPool_AddPrimitives.
+#define MESHPOOL_RESTART_INDEX 0xFFFFFFFFu
+
+typedef struct
+{
+    GLuint index;
+    GLint size;
+    GLenum type;
+    GLboolean normalized;
+    GLuint offset;
+} MeshAttribute;
+
+typedef struct
+{
+    int offset;
+    int size;
+    int isFree;
+    // Neighbours in the arena, and in the free list of the block's size class.
+    int prevPhysical;
+    int nextPhysical;
+    int prevFree;
+    int nextFree;
+} MeshBlock;
+
+// Two-level segregated fit over [0, capacity) in vertices or index bytes: every
+// allocation and free is O(1), and freed neighbours merge immediately.
+typedef struct
+{
+    int capacity;
+    int used;
+    MeshBlock* blocks;
+    int blockCount;
+    int blockCapacity;
+    // Unused block records, chained through nextFree.
+    int spareBlock;
+    unsigned int firstLevel;
+    unsigned int secondLevel[MESHPOOL_FL_COUNT];
+    int heads[MESHPOOL_FL_COUNT][MESHPOOL_SL_COUNT];
+} MeshArena;
+
+// One vertex buffer and one index buffer, with a VAO that reads the pool's layout from them.
+typedef struct
+{
+    GLuint vao;
+    GLuint vertexBuffer;
+    GLuint indexBuffer;
+    MeshArena vertices;
+    MeshArena indices;
+} MeshPage;
+
+// Where a mesh lives, for glDrawElementsBaseVertex on its page's VAO.
+typedef struct
+{
+    int page;
+    GLenum mode;
+    GLint baseVertex;
+    // In indexType units, the smallest type that holds the mesh's largest index.
+    GLuint firstIndex;
+    GLenum indexType;
+    int primitiveRestart;
+    GLsizei vertexCount;
+    GLsizei indexCount;
+    int vertexBlock;
+    int indexBlock;
+} MeshRange;
+
+typedef struct
+{
+    int pageCount;
+    int meshCount;
+    size_t vertexBytes;
+    size_t usedVertexBytes;
+    size_t indexBytes;
+    size_t usedIndexBytes;
+    // Index memory the live meshes would take as 32-bit indices, less what they take.
+    size_t savedIndexBytes;
+    int freeBlockCount;
+    // 1 - largest free block / free space, over both kinds of buffer; 0 when all
+    // free space is contiguous in each page.
+    float fragmentation;
+} MeshPoolStats;
+
+// Meshes sharing one vertex layout, suballocated from a few large vertex and index
+// buffers instead of a buffer pair per mesh. Consecutive draws from the same page
+// need no VAO change. Indices are relative to the mesh's own first vertex, so most
+// meshes store them as 16-bit, whatever size the page is. Between its draws the pool
+// owns the VAO binding and GL_PRIMITIVE_RESTART state.
+typedef struct
+{
+    GLsizei vertexSize;
+    MeshAttribute attributes[MESHPOOL_MAX_ATTRIBUTES];
+    int attributeCount;
+    int pageVertexCount;
+    int pageIndexCount;
+    // 8-bit indices for meshes under 255 vertices; off by default, as some desktop
+    // drivers widen them on the CPU at draw time.
+    int allowByteIndices;
+    MeshPage pages[MESHPOOL_MAX_PAGES];
+    int pageCount;
+    MeshRange* meshes;
+    int meshCount;
+    int meshCapacity;
+    // Removed handles, chained through MeshRange.vertexBlock.
+    int spareMesh;
+    int boundPage;
+    int restartEnabled;
+    GLuint restartIndex;
+    int vaoBindCount;
+    int drawCount;
+} MeshPool;
+
+void MeshPool_Init(MeshPool* pool, GLsizei vertexSize, const MeshAttribute* attributes, int attributeCount,
+                   int pageVertexCount, int pageIndexCount);
+void MeshPool_Free(MeshPool* pool);
+int MeshPool_Add(MeshPool* pool, const void* vertices, int vertexCount, const unsigned int* indices, int indexCount);
+int MeshPool_AddPrimitives(MeshPool* pool, GLenum mode, const void* vertices, int vertexCount,
+                           const unsigned int* indices, int indexCount);
+void MeshPool_Remove(MeshPool* pool, int handle);
+const MeshRange* MeshPool_Mesh(const MeshPool* pool, int handle);
+void MeshPool_Draw(MeshPool* pool, int handle);
+void MeshPool_DrawInstanced(MeshPool* pool, int handle, GLsizei instanceCount);
+int MeshPool_Defragment(MeshPool* pool);
+void MeshPool_Stats(const MeshPool* pool, MeshPoolStats* stats);
+void MeshPool_Report(const MeshPool* pool);
+
+#endif
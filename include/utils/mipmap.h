@@ -0,0 +1,18 @@
+#ifndef MIPMAP_H
+#define MIPMAP_H
+
+#include "utils/image.h"
+
+typedef enum
+{
+    MipFilter_Box,
+    MipFilter_Kaiser
+} MipFilter;
+
+int Mip_LevelCount(int width, int height);
+void Mip_Downsample(const unsigned char* src, int srcWidth, int srcHeight,
+                    unsigned char* dst, int dstWidth, int dstHeight,
+                    int channelCount, int srgb, MipFilter filter);
+int Mip_GenerateChain(Image* image, MipFilter filter);
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef PREPROCESSOR_H
+#define PREPROCESSOR_H
+
+#include "utils/shaderbatch.h"
+
+#include <stdint.h>
+
+#define PREPROCESSOR_MAX_DEPTH 16
+
+typedef struct
+{
+    char* path;
+    uint64_t contentHash;
+} ShaderDependency;
+
+// One root file with its includes spliced in. dependencies[0] is the root, and a
+// dependency's index is the source string number its #line directives use, so
+// compiler errors of the form "N:line" map back to dependencies[N].path.
+typedef struct
+{
+    char* text;
+    ShaderDependency* dependencies;
+    int dependencyCount;
+    int dependencyCapacity;
+} ShaderExpansion;
+
+// Resolves #include "file" relative to the including file, splices each file in at
+// most once per expansion, and keeps the first #version on top. Expansions are
+// memoised per root and reused while every dependency's content hash still matches.
+typedef struct
+{
+    ShaderExpansion** expansions;
+    int expansionCount;
+    int expansionCapacity;
+    int hitCount;
+    int missCount;
+    ShaderErrorFunc onError;
+    void* userData;
+} Preprocessor;
+
+void Preprocessor_Init(Preprocessor* preprocessor, ShaderErrorFunc onError, void* userData);
+void Preprocessor_Free(Preprocessor* preprocessor);
+const ShaderExpansion* Preprocessor_Expand(Preprocessor* preprocessor, const char* fileName);
+int Preprocessor_IsStale(const Preprocessor* preprocessor, const char* fileName);
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef PROGCACHE_H
+#define PROGCACHE_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stdint.h>
+
+// stage is "vertex", "fragment" or "link"; log is the driver's info log.
+typedef void (*ShaderErrorFunc)(const char* name, const char* stage, const char* log, void* userData);
+
+// Linked program binaries on disk, keyed by the shader sources and the driver's
+// vendor, renderer and version strings. Without ARB_get_program_binary, or when
+// the driver rejects a stored binary, programs are compiled as usual.
+typedef struct
+{
+    const char* cacheDir;
+    int hitCount;
+    int missCount;
+    // Build time recorded when each hit was stored, less the time it took to load.
+    double savedSeconds;
+    // Build errors from ProgCache_Build; ShaderBatch_PrintError unless set.
+    ShaderErrorFunc onError;
+    void* userData;
+} ProgCache;
+
+void ProgCache_Init(ProgCache* cache, const char* cacheDir);
+void ProgCache_SetErrorHandler(ProgCache* cache, ShaderErrorFunc onError, void* userData);
+GLuint ProgCache_Build(ProgCache* cache, const char* name, const char* vertSrc, const char* fragSrc, GLFWwindow* window);
+GLuint ProgCache_BuildWithKey(ProgCache* cache, const char* name, uint64_t key, const char* vertSrc,
+                              const char* fragSrc, GLFWwindow* window);
+void ProgCache_Report(const ProgCache* cache);
+
+// The pieces of ProgCache_Build, for callers that compile asynchronously.
+uint64_t ProgCache_Key(const char* vertSrc, const char* fragSrc);
+// Same key from Hash_String(source, 0) of each stage, e.g. the hashes of embedded shaders.
+uint64_t ProgCache_KeyFromHashes(uint64_t vertHash, uint64_t fragHash);
+GLuint ProgCache_Load(ProgCache* cache, uint64_t key);
+void ProgCache_PrepareLink(const ProgCache* cache, GLuint program);
+void ProgCache_Store(ProgCache* cache, uint64_t key, GLuint program, double buildSeconds);
+
+#endif
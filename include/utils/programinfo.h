@@ -0,0 +1,76 @@
+#ifndef PROGRAMINFO_H
+#define PROGRAMINFO_H
+
+#include <glad/glad.h>
+#include <stdint.h>
+
+// Largest uniform the setters cache: a mat4.
+#define PROGRAMINFO_MAX_VALUE_SIZE 64
+
+typedef struct
+{
+    char* name;
+    GLint location;
+    GLenum type;
+    GLint size;
+    // Last value set through the setters, so setting it again costs no GL call.
+    unsigned char value[PROGRAMINFO_MAX_VALUE_SIZE];
+    int hasValue;
+} UniformInfo;
+
+typedef struct
+{
+    char* name;
+    GLint location;
+    GLenum type;
+    GLint size;
+} AttributeInfo;
+
+typedef struct
+{
+    char* name;
+    GLuint index;
+    GLint dataSize;
+    GLint binding;
+} BlockInfo;
+
+typedef struct
+{
+    uint64_t hash;
+    int kind;
+    int index;
+} ProgramInfoSlot;
+
+// What a linked program exposes: its active uniforms outside blocks, attributes and
+// uniform blocks, found by name through one hash table. Array names are stored
+// without their "[0]". Setters apply to the current program and skip values it already has.
+typedef struct
+{
+    GLuint program;
+    UniformInfo* uniforms;
+    int uniformCount;
+    AttributeInfo* attributes;
+    int attributeCount;
+    BlockInfo* blocks;
+    int blockCount;
+    ProgramInfoSlot* slots;
+    int slotCount;
+    int setCount;
+    int skippedCount;
+} ProgramInfo;
+
+void ProgramInfo_Init(ProgramInfo* info, GLuint program);
+void ProgramInfo_Free(ProgramInfo* info);
+int ProgramInfo_Uniform(const ProgramInfo* info, const char* name);
+GLint ProgramInfo_Attribute(const ProgramInfo* info, const char* name);
+int ProgramInfo_Block(const ProgramInfo* info, const char* name);
+void ProgramInfo_BindBlock(ProgramInfo* info, int block, GLuint binding);
+
+void ProgramInfo_SetInt(ProgramInfo* info, int uniform, int value);
+void ProgramInfo_SetFloat(ProgramInfo* info, int uniform, float value);
+void ProgramInfo_SetVec2(ProgramInfo* info, int uniform, float x, float y);
+void ProgramInfo_SetVec3(ProgramInfo* info, int uniform, float x, float y, float z);
+void ProgramInfo_SetVec4(ProgramInfo* info, int uniform, float x, float y, float z, float w);
+void ProgramInfo_SetMat4(ProgramInfo* info, int uniform, const float* matrix);
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef SHADERBATCH_H
+#define SHADERBATCH_H
+
+#include "utils/progcache.h"
+
+typedef enum
+{
+    BatchState_Queued,
+    BatchState_Compiling,
+    BatchState_Ready,
+    BatchState_Failed
+} BatchState;
+
+typedef struct
+{
+    const char* name;
+    // Only read until the batch is submitted.
+    const char* vertSrc;
+    const char* fragSrc;
+    size_t vertBytes;
+    size_t fragBytes;
+    uint64_t key;
+    GLuint vertShader;
+    GLuint fragShader;
+    GLuint program;
+    BatchState state;
+    double submitTime;
+    // Time spent inside this program's compile and link calls.
+    double issueSeconds;
+} BatchProgram;
+
+// Compiles many programs without stalling on each one: every compile and link is
+// issued up front, and completion is polled once per frame. With parallel shader
+// compile the driver works on them in the background; without it Poll finishes
+// one program per call so the cost is spread over frames. The batch owns its programs.
+typedef struct
+{
+    BatchProgram* programs;
+    int programCount;
+    int programCapacity;
+    ProgCache* cache;
+    ShaderErrorFunc onError;
+    void* userData;
+} ShaderBatch;
+
+void ShaderBatch_Init(ShaderBatch* batch, ProgCache* cache, ShaderErrorFunc onError, void* userData);
+void ShaderBatch_Free(ShaderBatch* batch);
+int ShaderBatch_Add(ShaderBatch* batch, const char* name, const char* vertSrc, const char* fragSrc);
+void ShaderBatch_Submit(ShaderBatch* batch);
+int ShaderBatch_Poll(ShaderBatch* batch);
+void ShaderBatch_Wait(ShaderBatch* batch);
+GLuint ShaderBatch_Program(const ShaderBatch* batch, int index);
+GLuint ShaderBatch_Take(ShaderBatch* batch, int index);
+void ShaderBatch_PrintError(const char* name, const char* stage, const char* log, void* userData);
+
+#endif
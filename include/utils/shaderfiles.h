@@ -0,0 +1,20 @@
+#ifndef SHADERFILES_H
+#define SHADERFILES_H
+
+#include <stdint.h>
+
+// One entry of the table tools/embed_shaders.c generates into embedded_shaders.h.
+// hash is Hash_String(source, 0), for ProgCache_KeyFromHashes.
+typedef struct
+{
+    const char* name;
+    uint64_t hash;
+    const char* source;
+} EmbeddedShader;
+
+void ShaderFiles_Register(const EmbeddedShader* shaders, int count);
+void ShaderFiles_PreferDisk(int preferDisk);
+const EmbeddedShader* ShaderFiles_Find(const char* name);
+char* ShaderFiles_Read(const char* name);
+
+#endif
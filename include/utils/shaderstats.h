@@ -0,0 +1,33 @@
+#ifndef SHADERSTATS_H
+#define SHADERSTATS_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SHADERSTATS_NAME_SIZE 96
+
+// One program build. Stage times are known for blocking builds only; an async build
+// records its time in the driver's compile and link calls and the final status
+// query, or with parallel compile, from submit until completion was first seen.
+typedef struct
+{
+    char name[SHADERSTATS_NAME_SIZE];
+    uint64_t key;
+    size_t vertBytes;
+    size_t fragBytes;
+    double vertSeconds;
+    double fragSeconds;
+    double linkSeconds;
+    double totalSeconds;
+    int cacheHit;
+    int async;
+    int success;
+} ShaderStat;
+
+void ShaderStats_Record(const char* name, uint64_t key, const char* vertSrc, const char* fragSrc, ShaderStat* stat);
+void ShaderStats_Print(FILE* file);
+int ShaderStats_WriteJson(const char* path);
+void ShaderStats_ReportAtExit(const char* jsonPath);
+
+#endif
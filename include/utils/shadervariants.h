@@ -0,0 +1,46 @@
+#ifndef SHADERVARIANTS_H
+#define SHADERVARIANTS_H
+
+#include "utils/shaderbatch.h"
+
+#include <stdint.h>
+
+typedef struct
+{
+    // Canonical define set: "NAME" or "NAME=value" entries sorted by name, joined with ';'.
+    char* defines;
+    uint64_t key;
+    // Program name plus defines, for error reports.
+    char* name;
+    char* vertSrc;
+    char* fragSrc;
+    // -1 until the variant is first built.
+    int batchIndex;
+} ShaderVariant;
+
+// One vertex/fragment source pair compiled with different #define sets. Define sets
+// that differ only in order or spacing share a variant, variants compile on first
+// use unless precompiled, and linked programs go through the program cache under
+// each variant's own source, so every variant is cached separately.
+typedef struct
+{
+    char* name;
+    char* vertSrc;
+    char* fragSrc;
+    ShaderVariant* variants;
+    int variantCount;
+    int variantCapacity;
+    ShaderBatch batch;
+} ShaderVariants;
+
+void ShaderVariants_Init(ShaderVariants* variants, const char* name, const char* vertSrc, const char* fragSrc,
+                         ProgCache* cache, ShaderErrorFunc onError, void* userData);
+void ShaderVariants_Free(ShaderVariants* variants);
+int ShaderVariants_Declare(ShaderVariants* variants, const char* defines);
+void ShaderVariants_Precompile(ShaderVariants* variants);
+int ShaderVariants_Poll(ShaderVariants* variants);
+GLuint ShaderVariants_Program(const ShaderVariants* variants, int handle);
+GLuint ShaderVariants_Get(ShaderVariants* variants, int handle);
+char* ShaderVariants_Source(const char* source, const char* defines);
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <string.h>
+
+// Four float lanes: SSE2 on x86, NEON on arm64, plain C elsewhere.
+#if defined(__SSE2__)
+#include <emmintrin.h>
+typedef __m128 Vec4;
+static inline Vec4 Vec4_Zero(void) { return _mm_setzero_ps(); }
+static inline Vec4 Vec4_Splat(float x) { return _mm_set1_ps(x); }
+static inline Vec4 Vec4_Load(const float* p) { return _mm_loadu_ps(p); }
+static inline void Vec4_Store(float* p, Vec4 v) { _mm_storeu_ps(p, v); }
+static inline Vec4 Vec4_Add(Vec4 a, Vec4 b) { return _mm_add_ps(a, b); }
+static inline Vec4 Vec4_Sub(Vec4 a, Vec4 b) { return _mm_sub_ps(a, b); }
+static inline Vec4 Vec4_Mul(Vec4 a, Vec4 b) { return _mm_mul_ps(a, b); }
+static inline Vec4 Vec4_MulAdd(Vec4 acc, Vec4 a, Vec4 b) { return _mm_add_ps(acc, _mm_mul_ps(a, b)); }
+static inline Vec4 Vec4_Min(Vec4 a, Vec4 b) { return _mm_min_ps(a, b); }
+static inline Vec4 Vec4_Max(Vec4 a, Vec4 b) { return _mm_max_ps(a, b); }
+static inline Vec4 Vec4_Clamp01(Vec4 v) { return _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0f)); }
+// Lane-wise a < b ? x : y
+static inline Vec4 Vec4_SelectLess(Vec4 a, Vec4 b, Vec4 x, Vec4 y)
+{
+    __m128 mask = _mm_cmplt_ps(a, b);
+    return _mm_or_ps(_mm_and_ps(mask, x), _mm_andnot_ps(mask, y));
+}
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+typedef float32x4_t Vec4;
+static inline Vec4 Vec4_Zero(void) { return vdupq_n_f32(0.0f); }
+static inline Vec4 Vec4_Splat(float x) { return vdupq_n_f32(x); }
+static inline Vec4 Vec4_Load(const float* p) { return vld1q_f32(p); }
+static inline void Vec4_Store(float* p, Vec4 v) { vst1q_f32(p, v); }
+static inline Vec4 Vec4_Add(Vec4 a, Vec4 b) { return vaddq_f32(a, b); }
+static inline Vec4 Vec4_Sub(Vec4 a, Vec4 b) { return vsubq_f32(a, b); }
+static inline Vec4 Vec4_Mul(Vec4 a, Vec4 b) { return vmulq_f32(a, b); }
+static inline Vec4 Vec4_MulAdd(Vec4 acc, Vec4 a, Vec4 b) { return vmlaq_f32(acc, a, b); }
+static inline Vec4 Vec4_Min(Vec4 a, Vec4 b) { return vminq_f32(a, b); }
+static inline Vec4 Vec4_Max(Vec4 a, Vec4 b) { return vmaxq_f32(a, b); }
+static inline Vec4 Vec4_Clamp01(Vec4 v) { return vminq_f32(vmaxq_f32(v, vdupq_n_f32(0.0f)), vdupq_n_f32(1.0f)); }
+static inline Vec4 Vec4_SelectLess(Vec4 a, Vec4 b, Vec4 x, Vec4 y) { return vbslq_f32(vcltq_f32(a, b), x, y); }
+#else
+typedef struct { float e[4]; } Vec4;
+static inline Vec4 Vec4_Zero(void) { Vec4 r = {{0.0f, 0.0f, 0.0f, 0.0f}}; return r; }
+static inline Vec4 Vec4_Splat(float x) { Vec4 r = {{x, x, x, x}}; return r; }
+static inline Vec4 Vec4_Load(const float* p) { Vec4 r = {{p[0], p[1], p[2], p[3]}}; return r; }
+static inline void Vec4_Store(float* p, Vec4 v) { memcpy(p, v.e, sizeof(v.e)); }
+static inline Vec4 Vec4_Add(Vec4 a, Vec4 b) { for (int i = 0; i < 4; ++i) a.e[i] += b.e[i]; return a; }
+static inline Vec4 Vec4_Sub(Vec4 a, Vec4 b) { for (int i = 0; i < 4; ++i) a.e[i] -= b.e[i]; return a; }
+static inline Vec4 Vec4_Mul(Vec4 a, Vec4 b) { for (int i = 0; i < 4; ++i) a.e[i] *= b.e[i]; return a; }
+static inline Vec4 Vec4_MulAdd(Vec4 acc, Vec4 a, Vec4 b) { for (int i = 0; i < 4; ++i) acc.e[i] += a.e[i] * b.e[i]; return acc; }
+static inline Vec4 Vec4_Min(Vec4 a, Vec4 b) { for (int i = 0; i < 4; ++i) a.e[i] = a.e[i] < b.e[i] ? a.e[i] : b.e[i]; return a; }
+static inline Vec4 Vec4_Max(Vec4 a, Vec4 b) { for (int i = 0; i < 4; ++i) a.e[i] = a.e[i] > b.e[i] ? a.e[i] : b.e[i]; return a; }
+static inline Vec4 Vec4_Clamp01(Vec4 v) { return Vec4_Min(Vec4_Max(v, Vec4_Zero()), Vec4_Splat(1.0f)); }
+static inline Vec4 Vec4_SelectLess(Vec4 a, Vec4 b, Vec4 x, Vec4 y)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        x.e[i] = a.e[i] < b.e[i] ? x.e[i] : y.e[i];
+    }
+    return x;
+}
+#endif
+
+#endif
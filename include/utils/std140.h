@@ -0,0 +1,30 @@
+#ifndef STD140_H
+#define STD140_H
+
+#include <stddef.h>
+
+// Packs values one after another with std140 alignment, so the bytes match a
+// layout(std140) uniform block declaring the same members in the same order.
+// With data NULL nothing is written and only the size is measured.
+typedef struct
+{
+    unsigned char* data;
+    size_t capacity;
+    size_t offset;
+    int overflow;
+} Std140Writer;
+
+void Std140_Init(Std140Writer* writer, void* data, size_t capacity);
+void Std140_Int(Std140Writer* writer, int value);
+void Std140_Float(Std140Writer* writer, float value);
+void Std140_Vec2(Std140Writer* writer, const float* value);
+void Std140_Vec3(Std140Writer* writer, const float* value);
+void Std140_Vec4(Std140Writer* writer, const float* value);
+void Std140_Mat4(Std140Writer* writer, const float* matrix);
+void Std140_FloatArray(Std140Writer* writer, const float* values, int count);
+void Std140_Vec4Array(Std140Writer* writer, const float* values, int count);
+void Std140_BeginStruct(Std140Writer* writer);
+void Std140_EndStruct(Std140Writer* writer);
+size_t Std140_Size(const Std140Writer* writer);
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef STREAMRING_H
+#define STREAMRING_H
+
+#include <glad/glad.h>
+#include <stddef.h>
+
+#define STREAMRING_SEGMENTS 3
+
+// One vertex buffer split into a segment per frame in flight, for geometry rebuilt
+// every frame: debug lines, particles, UI. Writes go straight into the segment through
+// an unsynchronized mapping; the fence on each segment is the only synchronisation,
+// so the driver never stalls a map on GPU work and the buffer is never reallocated.
+typedef struct
+{
+    GLuint buffer;
+    size_t segmentSize;
+    int segment;
+    size_t head;
+    // Start of the current mapping in the segment, and where it is in memory; NULL when unmapped.
+    size_t mappedStart;
+    unsigned char* mapped;
+    GLsync fences[STREAMRING_SEGMENTS];
+    int mapCount;
+    // Frames that found their segment still in use by the GPU.
+    int waitCount;
+    int overflowCount;
+} StreamRing;
+
+void StreamRing_Init(StreamRing* ring, size_t segmentSize);
+void StreamRing_Free(StreamRing* ring);
+void StreamRing_BeginFrame(StreamRing* ring);
+void* StreamRing_Alloc(StreamRing* ring, size_t size, size_t alignment, GLintptr* offset);
+void StreamRing_Commit(StreamRing* ring);
+void StreamRing_EndFrame(StreamRing* ring);
+void StreamRing_Report(const StreamRing* ring);
+
+#endif
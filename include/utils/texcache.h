@@ -0,0 +1,16 @@
+#ifndef TEXCACHE_H
+#define TEXCACHE_H
+
+#include "utils/image.h"
+#include "utils/bcn.h"
+
+// Loads fileName through a cooked copy in cacheDir. A valid cache file is memory
+// mapped and the returned image points into it; otherwise the source is decoded,
+// mipmapped and compressed as requested on threadCount threads, and written to the
+// cache for next time.
+// sourceHash receives Hash_Bytes of the source file either way.
+int TexCache_Load(const char* cacheDir, const char* fileName, int flags,
+                  ImageFormat format, BcnQuality quality, int threadCount, Image* image, int* hit,
+                  uint64_t* sourceHash);
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef TEXREGISTRY_H
+#define TEXREGISTRY_H
+
+#include "utils/image.h"
+
+#include <stdint.h>
+
+typedef struct
+{
+    uint64_t sourceHash;
+    uint64_t pixelHash;
+    GLuint texture;
+    int refCount;
+    size_t bytes;
+} TexRegistryEntry;
+
+// Shares one GL texture between loads whose source bytes or decoded pixels hash
+// the same, e.g. one image referenced under several paths. Textures are reference
+// counted and deleted when the last user releases them.
+typedef struct
+{
+    TexRegistryEntry* entries;
+    int entryCount;
+    int entryCapacity;
+    int sourceMatchCount;
+    int pixelMatchCount;
+} TexRegistry;
+
+void TexRegistry_Init(TexRegistry* registry);
+void TexRegistry_Free(TexRegistry* registry);
+GLuint TexRegistry_Acquire(TexRegistry* registry, const Image* image, uint64_t sourceHash, uint64_t pixelHash);
+GLuint TexRegistry_Adopt(TexRegistry* registry, GLuint texture, size_t bytes, uint64_t sourceHash, uint64_t pixelHash);
+void TexRegistry_Release(TexRegistry* registry, GLuint texture);
+size_t TexRegistry_SavedBytes(const TexRegistry* registry);
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef TEXSTREAM_H
+#define TEXSTREAM_H
+
+#include "utils/image.h"
+
+// Levels no larger than this on either side form the always resident mip tail.
+#define TEXSTREAM_TAIL_SIZE 64
+
+typedef struct
+{
+    GLuint texture;
+    Image image;
+    // Finest level that must always stay resident.
+    int tailBase;
+    // Finest level currently on the GPU; levels residentBase..levelCount-1 are defined.
+    int residentBase;
+    // Finest level asked for since the last update, or -1 when not requested.
+    int requestedBase;
+    size_t residentBytes;
+    unsigned long long lastUsedFrame;
+} StreamedTexture;
+
+typedef struct
+{
+    size_t budget;
+    size_t uploadBytesPerFrame;
+    size_t residentBytes;
+    unsigned long long frame;
+    StreamedTexture* textures;
+    int textureCount;
+    int textureCapacity;
+    int uploadCount;
+    int evictionCount;
+} TexStream;
+
+void TexStream_Init(TexStream* stream, size_t budget, size_t uploadBytesPerFrame);
+void TexStream_Free(TexStream* stream);
+int TexStream_Add(TexStream* stream, Image* image);
+void TexStream_Request(TexStream* stream, int handle, float screenSize);
+GLuint TexStream_Texture(const TexStream* stream, int handle);
+void TexStream_Update(TexStream* stream);
+
+#endif
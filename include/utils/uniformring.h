@@ -0,0 +1,40 @@
+#ifndef UNIFORMRING_H
+#define UNIFORMRING_H
+
+#include <glad/glad.h>
+#include <stddef.h>
+
+#define UNIFORMRING_FRAMES 3
+#define UNIFORMRING_MAX_BINDINGS 16
+
+// One uniform buffer split into a region per frame in flight. Each frame, per-frame,
+// per-view and per-object blocks are packed into the CPU copy of its region, sent
+// with a single glBufferSubData, and draws bind their slice with glBindBufferRange.
+// A fence per region keeps the CPU from rewriting data the GPU is still reading.
+typedef struct
+{
+    GLuint buffer;
+    size_t frameSize;
+    size_t alignment;
+    unsigned char* staging;
+    int frame;
+    size_t head;
+    size_t uploaded;
+    GLsync fences[UNIFORMRING_FRAMES];
+    // Ranges last bound through the ring, so repeated binds are skipped.
+    GLintptr boundOffsets[UNIFORMRING_MAX_BINDINGS];
+    GLsizeiptr boundSizes[UNIFORMRING_MAX_BINDINGS];
+    int uploadCount;
+    int bindCount;
+    int skippedBindCount;
+} UniformRing;
+
+void UniformRing_Init(UniformRing* ring, size_t frameSize);
+void UniformRing_Free(UniformRing* ring);
+void UniformRing_BeginFrame(UniformRing* ring);
+void* UniformRing_Alloc(UniformRing* ring, size_t size, GLintptr* offset);
+void UniformRing_Upload(UniformRing* ring);
+void UniformRing_Bind(UniformRing* ring, GLuint binding, GLintptr offset, GLsizeiptr size);
+void UniformRing_EndFrame(UniformRing* ring);
+
+#endif
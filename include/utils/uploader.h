@@ -0,0 +1,42 @@
+#ifndef UPLOADER_H
+#define UPLOADER_H
+
+#include "utils/loader.h"
+
+#include <GLFW/glfw3.h>
+
+typedef struct Uploader Uploader;
+
+typedef enum
+{
+    UploadType_Texture,
+    UploadType_Buffer
+} UploadType;
+
+// Filled in by the caller, completed on the upload thread. Must stay alive until ready.
+typedef struct UploadJob
+{
+    UploadType type;
+    // Textures: decoded by the uploader's Loader with these options; the image is freed after upload.
+    // The uploader sets image.onDone and image.userData.
+    ImageJob image;
+    // Buffers: data must stay valid until the job is done.
+    GLenum target;
+    const void* data;
+    GLsizeiptr size;
+    GLenum usage;
+    // Results. For textures size is set to the bytes uploaded.
+    GLuint name;
+    GLsync fence;
+    int success;
+    int done;
+    struct UploadJob* next;
+} UploadJob;
+
+Uploader* Uploader_Create(GLFWwindow* window, Loader* loader);
+void Uploader_Destroy(Uploader* uploader);
+void Uploader_Submit(Uploader* uploader, UploadJob* job);
+int Uploader_IsReady(Uploader* uploader, UploadJob* job);
+void Uploader_Wait(Uploader* uploader, UploadJob* job);
+
+#endif
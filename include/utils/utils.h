@@ -7,8 +7,9 @@
 #define ArraySize(x) (sizeof(x)/sizeof(x[0]))
 
 GLFWwindow* Utils_CreateWindow(const char* title);
-void Utils_CheckShaderState(GLuint shader, GLFWwindow* window);
-void Utils_CheckProgramState(GLuint program, GLFWwindow* window);
+GLFWwindow* Utils_CreateSharedContext(GLFWwindow* window);
 char* Utils_ReadTextFile(const char* fileName);
+unsigned char* Utils_ReadBinaryFile(const char* fileName, size_t* size);
+int Utils_HasExtension(const char* name);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,50 @@
+#ifndef VERTEXFORMAT_H
+#define VERTEXFORMAT_H
+
+#include "utils/meshpool.h"
+
+#include <stdint.h>
+
+typedef enum
+{
+    // GL_FLOAT, 4 bytes a component.
+    VertexEncoding_Float,
+    // GL_HALF_FLOAT, 2 bytes a component; positions and UVs outside [0, 1].
+    VertexEncoding_Half,
+    // Normalized GL_SHORT, values in [-1, 1].
+    VertexEncoding_Snorm16,
+    // Normalized GL_UNSIGNED_SHORT, values in [0, 1]; UVs.
+    VertexEncoding_Unorm16,
+    // Normalized GL_INT_2_10_10_10_REV, 3 or 4 components in [-1, 1] in 4 bytes;
+    // normals and tangents. A fourth component keeps only its sign.
+    VertexEncoding_Snorm10,
+    // Normalized GL_UNSIGNED_BYTE, values in [0, 1]; colours.
+    VertexEncoding_Unorm8,
+} VertexEncoding;
+
+typedef struct
+{
+    GLuint index;
+    int componentCount;
+    VertexEncoding encoding;
+} VertexElement;
+
+// How float vertex data is stored on the GPU. Source vertices are the elements'
+// components as interleaved floats; VertexFormat_Pack encodes them, and the
+// attributes describe the result for glVertexAttribPointer or MeshPool_Init.
+// Out-of-range values clamp. Every attribute starts on a 4-byte boundary.
+typedef struct
+{
+    VertexElement elements[MESHPOOL_MAX_ATTRIBUTES];
+    MeshAttribute attributes[MESHPOOL_MAX_ATTRIBUTES];
+    int elementCount;
+    int sourceComponentCount;
+    GLsizei vertexSize;
+} VertexFormat;
+
+void VertexFormat_Init(VertexFormat* format, const VertexElement* elements, int elementCount);
+void VertexFormat_Pack(const VertexFormat* format, const float* source, int vertexCount, void* destination);
+void VertexFormat_Apply(const VertexFormat* format, const GLint* locations);
+uint16_t VertexFormat_Half(float value);
+
+#endif
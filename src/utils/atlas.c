@@ -0,0 +1,345 @@
+#include "utils/atlas.h"
+#include "utils/mipmap.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <assert.h>
+
+static int RoundUpPowerOfTwo(int x)
+{
+    int result = 1;
+    while (result < x)
+    {
+        result <<= 1;
+    }
+    return result;
+}
+
+static int AlignUp(int x, int alignment)
+{
+    return (x + alignment - 1) / alignment * alignment;
+}
+
+static void Skyline_Init(Skyline* skyline, int width)
+{
+    skyline->nodeCapacity = 16;
+    skyline->nodes = malloc(skyline->nodeCapacity * sizeof(SkylineNode));
+    assert(skyline->nodes);
+    skyline->nodes[0].x = 0;
+    skyline->nodes[0].y = 0;
+    skyline->nodes[0].width = width;
+    skyline->nodeCount = 1;
+}
+
+// Lowest y at which a w x h rect starting at node `index` clears the skyline, or -1.
+static int Skyline_Fit(const Skyline* skyline, int index, int w, int h, int pageSize)
+{
+    const SkylineNode* nodes = skyline->nodes;
+    if (nodes[index].x + w > pageSize)
+    {
+        return -1;
+    }
+
+    int y = nodes[index].y;
+    int widthLeft = w;
+    for (int i = index; widthLeft > 0 && i < skyline->nodeCount; ++i)
+    {
+        y = nodes[i].y > y ? nodes[i].y : y;
+        if (y + h > pageSize)
+        {
+            return -1;
+        }
+        widthLeft -= nodes[i].width;
+    }
+    return y;
+}
+
+static int Skyline_Insert(Skyline* skyline, int w, int h, int pageSize, int* outX, int* outY)
+{
+    int bestIndex = -1;
+    int bestY = INT_MAX;
+    int bestWidth = INT_MAX;
+    for (int i = 0; i < skyline->nodeCount; ++i)
+    {
+        int y = Skyline_Fit(skyline, i, w, h, pageSize);
+        if (y >= 0 && (y < bestY || (y == bestY && skyline->nodes[i].width < bestWidth)))
+        {
+            bestIndex = i;
+            bestY = y;
+            bestWidth = skyline->nodes[i].width;
+        }
+    }
+    if (bestIndex < 0)
+    {
+        return 0;
+    }
+
+    if (skyline->nodeCount + 1 > skyline->nodeCapacity)
+    {
+        skyline->nodeCapacity *= 2;
+        skyline->nodes = realloc(skyline->nodes, skyline->nodeCapacity * sizeof(SkylineNode));
+        assert(skyline->nodes);
+    }
+
+    SkylineNode* nodes = skyline->nodes;
+    int x = nodes[bestIndex].x;
+    memmove(nodes + bestIndex + 1, nodes + bestIndex, (skyline->nodeCount - bestIndex) * sizeof(SkylineNode));
+    nodes[bestIndex].x = x;
+    nodes[bestIndex].y = bestY + h;
+    nodes[bestIndex].width = w;
+    ++skyline->nodeCount;
+
+    // Trim or drop the nodes now covered by the new one.
+    int right = x + w;
+    int i = bestIndex + 1;
+    while (i < skyline->nodeCount && nodes[i].x < right)
+    {
+        int shrink = right - nodes[i].x;
+        if (shrink < nodes[i].width)
+        {
+            nodes[i].x += shrink;
+            nodes[i].width -= shrink;
+            break;
+        }
+        memmove(nodes + i, nodes + i + 1, (skyline->nodeCount - i - 1) * sizeof(SkylineNode));
+        --skyline->nodeCount;
+    }
+
+    // Merge neighbours at the same height.
+    for (i = 0; i + 1 < skyline->nodeCount;)
+    {
+        if (nodes[i].y == nodes[i + 1].y)
+        {
+            nodes[i].width += nodes[i + 1].width;
+            memmove(nodes + i + 1, nodes + i + 2, (skyline->nodeCount - i - 2) * sizeof(SkylineNode));
+            --skyline->nodeCount;
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    *outX = x;
+    *outY = bestY;
+    return 1;
+}
+
+static void ReadPixel(const Image* image, int x, int y, unsigned char rgba[4])
+{
+    const unsigned char* p = image->data + ((size_t)y * image->width + x) * image->channelCount;
+    switch (image->channelCount)
+    {
+        case 1: rgba[0] = rgba[1] = rgba[2] = p[0]; rgba[3] = 255; break;
+        case 2: rgba[0] = rgba[1] = rgba[2] = p[0]; rgba[3] = p[1]; break;
+        case 3: rgba[0] = p[0]; rgba[1] = p[1]; rgba[2] = p[2]; rgba[3] = 255; break;
+        default: memcpy(rgba, p, 4); break;
+    }
+}
+
+// Copies the image and clamps its border outwards through the gutter.
+static void Blit(Image* page, int pageSize, int x, int y, const Image* image, int padding)
+{
+    for (int dy = -padding; dy < image->height + padding; ++dy)
+    {
+        int sy = dy < 0 ? 0 : (dy >= image->height ? image->height - 1 : dy);
+        unsigned char* row = page->data + ((size_t)(y + padding + dy) * pageSize + x + padding) * 4;
+        for (int dx = -padding; dx < image->width + padding; ++dx)
+        {
+            int sx = dx < 0 ? 0 : (dx >= image->width ? image->width - 1 : dx);
+            ReadPixel(image, sx, sy, row + dx * 4);
+        }
+    }
+}
+
+static int AddPage(Atlas* atlas)
+{
+    if (atlas->pageCount >= ATLAS_MAX_PAGES)
+    {
+        return 0;
+    }
+
+    Image* page = atlas->pages + atlas->pageCount;
+    size_t size = (size_t)atlas->pageSize * atlas->pageSize * 4;
+    memset(page, 0, sizeof(*page));
+    page->data = calloc(size, 1);
+    if (!page->data)
+    {
+        return 0;
+    }
+    page->width = atlas->pageSize;
+    page->height = atlas->pageSize;
+    page->channelCount = 4;
+    page->flags = atlas->flags;
+    page->levelCount = 1;
+    page->levels[0].width = atlas->pageSize;
+    page->levels[0].height = atlas->pageSize;
+    page->levels[0].size = size;
+    page->dataSize = size;
+
+    Skyline_Init(atlas->skylines + atlas->pageCount, atlas->pageSize);
+    ++atlas->pageCount;
+    return 1;
+}
+
+void Atlas_Init(Atlas* atlas, int pageSize, int padding, int flags)
+{
+    memset(atlas, 0, sizeof(*atlas));
+    atlas->pageSize = pageSize;
+    atlas->padding = RoundUpPowerOfTwo(padding < 1 ? 1 : padding);
+    atlas->flags = flags;
+
+    atlas->levelCount = 1;
+    if (flags & IMAGE_FLAG_MIPMAPS)
+    {
+        for (int p = atlas->padding; p > 1; p >>= 1)
+        {
+            ++atlas->levelCount;
+        }
+    }
+}
+
+void Atlas_Free(Atlas* atlas)
+{
+    for (int i = 0; i < atlas->pageCount; ++i)
+    {
+        Image_Free(atlas->pages + i);
+        free(atlas->skylines[i].nodes);
+    }
+    memset(atlas, 0, sizeof(*atlas));
+}
+
+int Atlas_Add(Atlas* atlas, const Image* image, AtlasRect* rect)
+{
+    if (image->format != ImageFormat_Uncompressed)
+    {
+        return 0;
+    }
+
+    int w = AlignUp(image->width + 2 * atlas->padding, atlas->padding);
+    int h = AlignUp(image->height + 2 * atlas->padding, atlas->padding);
+    if (w > atlas->pageSize || h > atlas->pageSize)
+    {
+        return 0;
+    }
+
+    int page = 0;
+    int x, y;
+    for (; page < atlas->pageCount; ++page)
+    {
+        if (Skyline_Insert(atlas->skylines + page, w, h, atlas->pageSize, &x, &y))
+        {
+            break;
+        }
+    }
+    if (page == atlas->pageCount)
+    {
+        if (!AddPage(atlas) || !Skyline_Insert(atlas->skylines + page, w, h, atlas->pageSize, &x, &y))
+        {
+            return 0;
+        }
+    }
+
+    Blit(atlas->pages + page, atlas->pageSize, x, y, image, atlas->padding);
+
+    float scale = 1.0f / atlas->pageSize;
+    rect->page = page;
+    rect->u0 = (x + atlas->padding) * scale;
+    rect->v0 = (y + atlas->padding) * scale;
+    rect->u1 = (x + atlas->padding + image->width) * scale;
+    rect->v1 = (y + atlas->padding + image->height) * scale;
+    return 1;
+}
+
+typedef struct
+{
+    int index;
+    int width;
+    int height;
+} SortEntry;
+
+static int CompareHeight(const void* a, const void* b)
+{
+    const SortEntry* entryA = a;
+    const SortEntry* entryB = b;
+    if (entryA->height != entryB->height)
+    {
+        return entryB->height - entryA->height;
+    }
+    return entryB->width - entryA->width;
+}
+
+// Tallest first packs noticeably tighter than arrival order.
+int Atlas_AddBatch(Atlas* atlas, const Image* images, int count, AtlasRect* rects)
+{
+    SortEntry* order = malloc(count * sizeof(SortEntry));
+    assert(order);
+    for (int i = 0; i < count; ++i)
+    {
+        order[i].index = i;
+        order[i].width = images[i].width;
+        order[i].height = images[i].height;
+    }
+    qsort(order, count, sizeof(SortEntry), CompareHeight);
+
+    int result = 1;
+    for (int i = 0; i < count && result; ++i)
+    {
+        result = Atlas_Add(atlas, images + order[i].index, rects + order[i].index);
+    }
+
+    free(order);
+    return result;
+}
+
+int Atlas_Finish(Atlas* atlas)
+{
+    for (int i = 0; i < atlas->pageCount && atlas->levelCount > 1; ++i)
+    {
+        Image* page = atlas->pages + i;
+        if (!Mip_GenerateChain(page, MipFilter_Box))
+        {
+            return 0;
+        }
+        if (page->levelCount > atlas->levelCount)
+        {
+            const ImageLevel* last = page->levels + atlas->levelCount - 1;
+            page->levelCount = atlas->levelCount;
+            page->dataSize = last->offset + last->size;
+        }
+    }
+    return 1;
+}
+
+GLuint Atlas_CreateTexture(const Atlas* atlas, int page)
+{
+    GLuint result = Image_CreateTexture(atlas->pages + page);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    return result;
+}
+
+// Two triangles in the position (3 floats) + uv (2 floats) layout of texture.vert.
+void Atlas_WriteQuad(const AtlasRect* rect, float x0, float y0, float x1, float y1, float* vertices)
+{
+    float corners[6][4] =
+    {
+        {x0, y0, rect->u0, rect->v0},
+        {x1, y0, rect->u1, rect->v0},
+        {x1, y1, rect->u1, rect->v1},
+        {x0, y0, rect->u0, rect->v0},
+        {x1, y1, rect->u1, rect->v1},
+        {x0, y1, rect->u0, rect->v1},
+    };
+
+    for (int i = 0; i < 6; ++i)
+    {
+        float* v = vertices + i * 5;
+        v[0] = corners[i][0];
+        v[1] = corners[i][1];
+        v[2] = 0.0f;
+        v[3] = corners[i][2];
+        v[4] = corners[i][3];
+    }
+}
@@ -0,0 +1,796 @@
+#include "utils/bcn.h"
+#include "utils/simd.h"
+#include "utils/utils.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+
+#define BCN_MAX_THREADS 16
+
+// Structure of arrays so index fitting can test four pixels per instruction.
+typedef struct
+{
+    float r[16];
+    float g[16];
+    float b[16];
+} ColorBlock;
+
+typedef struct
+{
+    ImageFormat format;
+    BcnQuality quality;
+    const unsigned char* pixels;
+    int width;
+    int height;
+    int channelCount;
+    unsigned char* blocks;
+    int firstRow;
+    int lastRow;
+} CompressTask;
+
+static inline float Clamp255(float x)
+{
+    return x < 0.0f ? 0.0f : (x > 255.0f ? 255.0f : x);
+}
+
+static int BlockSize(ImageFormat format)
+{
+    return (format == ImageFormat_BC1 || format == ImageFormat_BC4) ? 8 : 16;
+}
+
+static int AlphaChannel(int channelCount)
+{
+    return channelCount == 4 ? 3 : (channelCount == 2 ? 1 : -1);
+}
+
+static void GatherChannel(const unsigned char* pixels, int width, int height, int channelCount,
+                          int bx, int by, int channel, unsigned char out[16])
+{
+    for (int i = 0; i < 16; ++i)
+    {
+        int x = bx * 4 + (i & 3);
+        int y = by * 4 + (i >> 2);
+        x = x < width ? x : width - 1;
+        y = y < height ? y : height - 1;
+        out[i] = channel < 0 ? 255 : pixels[((size_t)y * width + x) * channelCount + channel];
+    }
+}
+
+static void GatherColor(const unsigned char* pixels, int width, int height, int channelCount,
+                        int bx, int by, ColorBlock* block)
+{
+    unsigned char r[16], g[16], b[16];
+    int grey = channelCount < 3;
+    GatherChannel(pixels, width, height, channelCount, bx, by, 0, r);
+    GatherChannel(pixels, width, height, channelCount, bx, by, grey ? 0 : 1, g);
+    GatherChannel(pixels, width, height, channelCount, bx, by, grey ? 0 : 2, b);
+    for (int i = 0; i < 16; ++i)
+    {
+        block->r[i] = r[i];
+        block->g[i] = g[i];
+        block->b[i] = b[i];
+    }
+}
+
+static unsigned short PackRgb565(const float c[3])
+{
+    int r = (int)(Clamp255(c[0]) * 31.0f / 255.0f + 0.5f);
+    int g = (int)(Clamp255(c[1]) * 63.0f / 255.0f + 0.5f);
+    int b = (int)(Clamp255(c[2]) * 31.0f / 255.0f + 0.5f);
+    return (unsigned short)((r << 11) | (g << 5) | b);
+}
+
+static void UnpackRgb565(unsigned short v, int c[3])
+{
+    int r = v >> 11;
+    int g = (v >> 5) & 63;
+    int b = v & 31;
+    c[0] = (r << 3) | (r >> 2);
+    c[1] = (g << 2) | (g >> 4);
+    c[2] = (b << 3) | (b >> 2);
+}
+
+static float FitColorIndices(const ColorBlock* block, const float palette[4][3], unsigned char indices[16])
+{
+    float error = 0.0f;
+    float distances[4];
+    float best[4];
+
+    for (int p = 0; p < 16; p += 4)
+    {
+        Vec4 r = Vec4_Load(block->r + p);
+        Vec4 g = Vec4_Load(block->g + p);
+        Vec4 b = Vec4_Load(block->b + p);
+        Vec4 bestDistance = Vec4_Splat(FLT_MAX);
+        Vec4 bestIndex = Vec4_Zero();
+
+        for (int i = 0; i < 4; ++i)
+        {
+            Vec4 dr = Vec4_Sub(r, Vec4_Splat(palette[i][0]));
+            Vec4 dg = Vec4_Sub(g, Vec4_Splat(palette[i][1]));
+            Vec4 db = Vec4_Sub(b, Vec4_Splat(palette[i][2]));
+            Vec4 d = Vec4_MulAdd(Vec4_MulAdd(Vec4_Mul(dr, dr), dg, dg), db, db);
+            bestIndex = Vec4_SelectLess(d, bestDistance, Vec4_Splat((float)i), bestIndex);
+            bestDistance = Vec4_Min(d, bestDistance);
+        }
+
+        Vec4_Store(distances, bestDistance);
+        Vec4_Store(best, bestIndex);
+        for (int k = 0; k < 4; ++k)
+        {
+            error += distances[k];
+            indices[p + k] = (unsigned char)best[k];
+        }
+    }
+
+    return error;
+}
+
+// Orders the endpoints for four-colour mode and picks the best index per pixel.
+static float EvaluateColorEndpoints(const ColorBlock* block, unsigned short* e0, unsigned short* e1,
+                                    unsigned char indices[16])
+{
+    if (*e0 < *e1)
+    {
+        unsigned short swap = *e0;
+        *e0 = *e1;
+        *e1 = swap;
+    }
+
+    int c0[3], c1[3];
+    UnpackRgb565(*e0, c0);
+    UnpackRgb565(*e1, c1);
+
+    float palette[4][3];
+    for (int c = 0; c < 3; ++c)
+    {
+        palette[0][c] = (float)c0[c];
+        palette[1][c] = (float)c1[c];
+        if (*e0 == *e1)
+        {
+            // Three-colour mode: the interpolants are never the better choice here.
+            palette[2][c] = palette[3][c] = (float)c0[c];
+        }
+        else
+        {
+            palette[2][c] = (2.0f * c0[c] + c1[c]) / 3.0f;
+            palette[3][c] = (c0[c] + 2.0f * c1[c]) / 3.0f;
+        }
+    }
+
+    return FitColorIndices(block, palette, indices);
+}
+
+static void BoundingBoxEndpoints(const ColorBlock* block, float e0[3], float e1[3])
+{
+    const float* channels[3] = {block->r, block->g, block->b};
+    float mean[3] = {0.0f, 0.0f, 0.0f};
+    for (int i = 0; i < 16; ++i)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            mean[c] += channels[c][i] / 16.0f;
+        }
+    }
+
+    // Green decides the diagonal; red and blue flip when they run against it.
+    float covRg = 0.0f, covBg = 0.0f;
+    for (int i = 0; i < 16; ++i)
+    {
+        covRg += (block->r[i] - mean[0]) * (block->g[i] - mean[1]);
+        covBg += (block->b[i] - mean[2]) * (block->g[i] - mean[1]);
+    }
+
+    for (int c = 0; c < 3; ++c)
+    {
+        float lo = channels[c][0], hi = channels[c][0];
+        for (int i = 1; i < 16; ++i)
+        {
+            lo = fminf(lo, channels[c][i]);
+            hi = fmaxf(hi, channels[c][i]);
+        }
+        float inset = (hi - lo) / 16.0f;
+        lo += inset;
+        hi -= inset;
+
+        int flip = (c == 0 && covRg < 0.0f) || (c == 2 && covBg < 0.0f);
+        e0[c] = flip ? lo : hi;
+        e1[c] = flip ? hi : lo;
+    }
+}
+
+static void PrincipalAxisEndpoints(const ColorBlock* block, float e0[3], float e1[3])
+{
+    float mean[3] = {0.0f, 0.0f, 0.0f};
+    for (int i = 0; i < 16; ++i)
+    {
+        mean[0] += block->r[i] / 16.0f;
+        mean[1] += block->g[i] / 16.0f;
+        mean[2] += block->b[i] / 16.0f;
+    }
+
+    float cov[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    for (int i = 0; i < 16; ++i)
+    {
+        float r = block->r[i] - mean[0];
+        float g = block->g[i] - mean[1];
+        float b = block->b[i] - mean[2];
+        cov[0] += r * r;
+        cov[1] += r * g;
+        cov[2] += r * b;
+        cov[3] += g * g;
+        cov[4] += g * b;
+        cov[5] += b * b;
+    }
+
+    float axis[3] = {1.0f, 1.0f, 1.0f};
+    for (int iteration = 0; iteration < 8; ++iteration)
+    {
+        float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+        float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+        float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+        float length = fmaxf(fabsf(x), fmaxf(fabsf(y), fabsf(z)));
+        if (length < 1e-6f)
+        {
+            break;
+        }
+        axis[0] = x / length;
+        axis[1] = y / length;
+        axis[2] = z / length;
+    }
+
+    float lengthSq = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+    if (lengthSq < 1e-12f || cov[0] + cov[3] + cov[5] < 1e-6f)
+    {
+        // Flat block or degenerate axis.
+        BoundingBoxEndpoints(block, e0, e1);
+        return;
+    }
+
+    float invLength = 1.0f / sqrtf(lengthSq);
+    axis[0] *= invLength;
+    axis[1] *= invLength;
+    axis[2] *= invLength;
+
+    float lo = FLT_MAX, hi = -FLT_MAX;
+    for (int i = 0; i < 16; ++i)
+    {
+        float t = (block->r[i] - mean[0]) * axis[0] + (block->g[i] - mean[1]) * axis[1] + (block->b[i] - mean[2]) * axis[2];
+        lo = fminf(lo, t);
+        hi = fmaxf(hi, t);
+    }
+    float inset = (hi - lo) / 16.0f;
+    lo += inset;
+    hi -= inset;
+
+    for (int c = 0; c < 3; ++c)
+    {
+        e0[c] = Clamp255(mean[c] + axis[c] * hi);
+        e1[c] = Clamp255(mean[c] + axis[c] * lo);
+    }
+}
+
+// Least squares endpoints for the current index assignment.
+static int RefineColorEndpoints(const ColorBlock* block, const unsigned char indices[16], float e0[3], float e1[3])
+{
+    static const float weights[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+    const float* channels[3] = {block->r, block->g, block->b};
+
+    float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+    float ax[3] = {0.0f, 0.0f, 0.0f};
+    float bx[3] = {0.0f, 0.0f, 0.0f};
+    for (int i = 0; i < 16; ++i)
+    {
+        float a = weights[indices[i]];
+        float b = 1.0f - a;
+        aa += a * a;
+        bb += b * b;
+        ab += a * b;
+        for (int c = 0; c < 3; ++c)
+        {
+            ax[c] += a * channels[c][i];
+            bx[c] += b * channels[c][i];
+        }
+    }
+
+    float det = aa * bb - ab * ab;
+    if (fabsf(det) < 1e-6f)
+    {
+        return 0;
+    }
+
+    for (int c = 0; c < 3; ++c)
+    {
+        e0[c] = Clamp255((ax[c] * bb - bx[c] * ab) / det);
+        e1[c] = Clamp255((bx[c] * aa - ax[c] * ab) / det);
+    }
+    return 1;
+}
+
+static void EncodeColorBlock(const ColorBlock* block, BcnQuality quality, unsigned char* out)
+{
+    float e0[3], e1[3];
+    if (quality == BcnQuality_Fast)
+    {
+        BoundingBoxEndpoints(block, e0, e1);
+    }
+    else
+    {
+        PrincipalAxisEndpoints(block, e0, e1);
+    }
+
+    unsigned short color0 = PackRgb565(e0);
+    unsigned short color1 = PackRgb565(e1);
+    unsigned char indices[16];
+    float error = EvaluateColorEndpoints(block, &color0, &color1, indices);
+
+    for (int iteration = 0; quality == BcnQuality_High && iteration < 2; ++iteration)
+    {
+        if (!RefineColorEndpoints(block, indices, e0, e1))
+        {
+            break;
+        }
+
+        unsigned short candidate0 = PackRgb565(e0);
+        unsigned short candidate1 = PackRgb565(e1);
+        unsigned char candidateIndices[16];
+        float candidateError = EvaluateColorEndpoints(block, &candidate0, &candidate1, candidateIndices);
+        if (candidateError >= error)
+        {
+            break;
+        }
+
+        color0 = candidate0;
+        color1 = candidate1;
+        error = candidateError;
+        memcpy(indices, candidateIndices, sizeof(indices));
+    }
+
+    unsigned int bits = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        bits |= (unsigned int)(color0 == color1 ? 0 : indices[i]) << (2 * i);
+    }
+
+    out[0] = color0 & 0xFF;
+    out[1] = color0 >> 8;
+    out[2] = color1 & 0xFF;
+    out[3] = color1 >> 8;
+    out[4] = bits & 0xFF;
+    out[5] = (bits >> 8) & 0xFF;
+    out[6] = (bits >> 16) & 0xFF;
+    out[7] = bits >> 24;
+}
+
+static void ScalarPalette(int a0, int a1, int palette[8])
+{
+    palette[0] = a0;
+    palette[1] = a1;
+    if (a0 > a1)
+    {
+        for (int i = 2; i < 8; ++i)
+        {
+            palette[i] = ((8 - i) * a0 + (i - 1) * a1 + 3) / 7;
+        }
+    }
+    else
+    {
+        for (int i = 2; i < 6; ++i)
+        {
+            palette[i] = ((6 - i) * a0 + (i - 1) * a1 + 2) / 5;
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+static int FitScalarIndices(const unsigned char values[16], int a0, int a1, unsigned char indices[16])
+{
+    int palette[8];
+    ScalarPalette(a0, a1, palette);
+
+    int error = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        int bestDistance = 256 * 256;
+        for (int k = 0; k < 8; ++k)
+        {
+            int d = (values[i] - palette[k]) * (values[i] - palette[k]);
+            if (d < bestDistance)
+            {
+                bestDistance = d;
+                indices[i] = (unsigned char)k;
+            }
+        }
+        error += bestDistance;
+    }
+    return error;
+}
+
+static void EncodeScalarBlock(const unsigned char values[16], BcnQuality quality, unsigned char* out)
+{
+    int lo = 255, hi = 0;
+    int innerLo = 255, innerHi = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        lo = values[i] < lo ? values[i] : lo;
+        hi = values[i] > hi ? values[i] : hi;
+        if (values[i] != 0 && values[i] != 255)
+        {
+            innerLo = values[i] < innerLo ? values[i] : innerLo;
+            innerHi = values[i] > innerHi ? values[i] : innerHi;
+        }
+    }
+
+    int a0 = hi, a1 = lo;
+    unsigned char indices[16];
+    int error = FitScalarIndices(values, a0, a1, indices);
+
+    // Six-value mode keeps exact 0 and 255, which helps blocks mixing hard edges with gradients.
+    if (quality == BcnQuality_High && innerLo <= innerHi && error > 0)
+    {
+        unsigned char candidateIndices[16];
+        int candidateError = FitScalarIndices(values, innerLo, innerHi, candidateIndices);
+        if (candidateError < error)
+        {
+            a0 = innerLo;
+            a1 = innerHi;
+            error = candidateError;
+            memcpy(indices, candidateIndices, sizeof(indices));
+        }
+    }
+
+    out[0] = (unsigned char)a0;
+    out[1] = (unsigned char)a1;
+    unsigned long long bits = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        bits |= (unsigned long long)indices[i] << (3 * i);
+    }
+    for (int i = 0; i < 6; ++i)
+    {
+        out[2 + i] = (bits >> (8 * i)) & 0xFF;
+    }
+}
+
+static void DecodeColorBlock(const unsigned char* in, unsigned char rgba[16][4])
+{
+    unsigned short e0 = in[0] | (in[1] << 8);
+    unsigned short e1 = in[2] | (in[3] << 8);
+    unsigned int bits = in[4] | (in[5] << 8) | (in[6] << 16) | ((unsigned int)in[7] << 24);
+
+    int palette[4][4];
+    UnpackRgb565(e0, palette[0]);
+    UnpackRgb565(e1, palette[1]);
+    for (int c = 0; c < 3; ++c)
+    {
+        if (e0 > e1)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        else
+        {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+    }
+    palette[0][3] = palette[1][3] = palette[2][3] = 255;
+    palette[3][3] = e0 > e1 ? 255 : 0;
+
+    for (int i = 0; i < 16; ++i)
+    {
+        int index = (bits >> (2 * i)) & 3;
+        for (int c = 0; c < 4; ++c)
+        {
+            rgba[i][c] = (unsigned char)palette[index][c];
+        }
+    }
+}
+
+static void DecodeScalarBlock(const unsigned char* in, unsigned char rgba[16][4], int channel)
+{
+    int palette[8];
+    ScalarPalette(in[0], in[1], palette);
+
+    unsigned long long bits = 0;
+    for (int i = 0; i < 6; ++i)
+    {
+        bits |= (unsigned long long)in[2 + i] << (8 * i);
+    }
+    for (int i = 0; i < 16; ++i)
+    {
+        rgba[i][channel] = (unsigned char)palette[(bits >> (3 * i)) & 7];
+    }
+}
+
+static void CompressBlockRows(const CompressTask* task)
+{
+    int blocksWide = (task->width + 3) / 4;
+    int blockSize = BlockSize(task->format);
+    int alpha = AlphaChannel(task->channelCount);
+    ColorBlock colorBlock;
+    unsigned char values[16];
+
+    for (int by = task->firstRow; by < task->lastRow; ++by)
+    {
+        for (int bx = 0; bx < blocksWide; ++bx)
+        {
+            unsigned char* out = task->blocks + ((size_t)by * blocksWide + bx) * blockSize;
+            switch (task->format)
+            {
+                case ImageFormat_BC1:
+                    GatherColor(task->pixels, task->width, task->height, task->channelCount, bx, by, &colorBlock);
+                    EncodeColorBlock(&colorBlock, task->quality, out);
+                    break;
+                case ImageFormat_BC3:
+                    GatherChannel(task->pixels, task->width, task->height, task->channelCount, bx, by, alpha, values);
+                    EncodeScalarBlock(values, task->quality, out);
+                    GatherColor(task->pixels, task->width, task->height, task->channelCount, bx, by, &colorBlock);
+                    EncodeColorBlock(&colorBlock, task->quality, out + 8);
+                    break;
+                case ImageFormat_BC4:
+                    GatherChannel(task->pixels, task->width, task->height, task->channelCount, bx, by, 0, values);
+                    EncodeScalarBlock(values, task->quality, out);
+                    break;
+                case ImageFormat_BC5:
+                    GatherChannel(task->pixels, task->width, task->height, task->channelCount, bx, by, 0, values);
+                    EncodeScalarBlock(values, task->quality, out);
+                    GatherChannel(task->pixels, task->width, task->height, task->channelCount, bx, by,
+                                  task->channelCount > 1 ? 1 : 0, values);
+                    EncodeScalarBlock(values, task->quality, out + 8);
+                    break;
+                default:
+                    assert(!"Not a block compressed format");
+            }
+        }
+    }
+}
+
+static void* CompressThread(void* param)
+{
+    CompressBlockRows(param);
+    return NULL;
+}
+
+ImageFormat Bcn_FormatForChannels(int channelCount)
+{
+    switch (channelCount)
+    {
+        case 1: return ImageFormat_BC4;
+        case 2: return ImageFormat_BC5;
+        case 3: return ImageFormat_BC1;
+        default: return ImageFormat_BC3;
+    }
+}
+
+int Bcn_IsSupported(ImageFormat format)
+{
+    switch (format)
+    {
+        case ImageFormat_BC1:
+        case ImageFormat_BC3:
+            return Utils_HasExtension("GL_EXT_texture_compression_s3tc");
+        case ImageFormat_BC4:
+        case ImageFormat_BC5:
+            // RGTC is core since GL 3.0.
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+GLenum Bcn_GLFormat(ImageFormat format)
+{
+    switch (format)
+    {
+        case ImageFormat_BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case ImageFormat_BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case ImageFormat_BC4: return GL_COMPRESSED_RED_RGTC1;
+        case ImageFormat_BC5: return GL_COMPRESSED_RG_RGTC2;
+        default: return GL_NONE;
+    }
+}
+
+size_t Bcn_LevelSize(ImageFormat format, int width, int height)
+{
+    return (size_t)((width + 3) / 4) * ((height + 3) / 4) * BlockSize(format);
+}
+
+void Bcn_CompressLevel(ImageFormat format, BcnQuality quality,
+                       const unsigned char* pixels, int width, int height, int channelCount,
+                       unsigned char* blocks, int threadCount)
+{
+    int blocksHigh = (height + 3) / 4;
+    if (threadCount > blocksHigh)
+    {
+        threadCount = blocksHigh;
+    }
+    if (threadCount > BCN_MAX_THREADS)
+    {
+        threadCount = BCN_MAX_THREADS;
+    }
+    if (threadCount < 1)
+    {
+        threadCount = 1;
+    }
+
+    CompressTask tasks[BCN_MAX_THREADS];
+    pthread_t threads[BCN_MAX_THREADS];
+    int started[BCN_MAX_THREADS] = {0};
+
+    for (int i = 0; i < threadCount; ++i)
+    {
+        CompressTask task = {format, quality, pixels, width, height, channelCount, blocks,
+                             blocksHigh * i / threadCount, blocksHigh * (i + 1) / threadCount};
+        tasks[i] = task;
+    }
+
+    // The calling thread takes the first slice; a failed spawn is done inline too.
+    for (int i = 1; i < threadCount; ++i)
+    {
+        started[i] = pthread_create(threads + i, NULL, CompressThread, tasks + i) == 0;
+    }
+    CompressBlockRows(tasks);
+    for (int i = 1; i < threadCount; ++i)
+    {
+        if (started[i])
+        {
+            pthread_join(threads[i], NULL);
+        }
+        else
+        {
+            CompressBlockRows(tasks + i);
+        }
+    }
+}
+
+void Bcn_DecompressLevel(ImageFormat format, const unsigned char* blocks,
+                         int width, int height, unsigned char* rgba)
+{
+    int blocksWide = (width + 3) / 4;
+    int blocksHigh = (height + 3) / 4;
+    int blockSize = BlockSize(format);
+    unsigned char texels[16][4];
+
+    for (int by = 0; by < blocksHigh; ++by)
+    {
+        for (int bx = 0; bx < blocksWide; ++bx)
+        {
+            const unsigned char* in = blocks + ((size_t)by * blocksWide + bx) * blockSize;
+            memset(texels, 0, sizeof(texels));
+            switch (format)
+            {
+                case ImageFormat_BC1:
+                    DecodeColorBlock(in, texels);
+                    break;
+                case ImageFormat_BC3:
+                    DecodeColorBlock(in + 8, texels);
+                    DecodeScalarBlock(in, texels, 3);
+                    break;
+                case ImageFormat_BC4:
+                    DecodeScalarBlock(in, texels, 0);
+                    break;
+                case ImageFormat_BC5:
+                    DecodeScalarBlock(in, texels, 0);
+                    DecodeScalarBlock(in + 8, texels, 1);
+                    break;
+                default:
+                    return;
+            }
+
+            for (int i = 0; i < 16; ++i)
+            {
+                int x = bx * 4 + (i & 3);
+                int y = by * 4 + (i >> 2);
+                if (x < width && y < height)
+                {
+                    memcpy(rgba + ((size_t)y * width + x) * 4, texels[i], 4);
+                }
+            }
+        }
+    }
+}
+
+int Bcn_CompressImage(Image* image, ImageFormat format, BcnQuality quality, int threadCount)
+{
+    if (image->format != ImageFormat_Uncompressed || format == ImageFormat_Uncompressed || image->mapping)
+    {
+        return 0;
+    }
+
+    ImageLevel levels[IMAGE_MAX_LEVELS];
+    size_t dataSize = 0;
+    for (int i = 0; i < image->levelCount; ++i)
+    {
+        levels[i] = image->levels[i];
+        levels[i].offset = dataSize;
+        levels[i].size = Bcn_LevelSize(format, levels[i].width, levels[i].height);
+        dataSize += levels[i].size;
+    }
+
+    unsigned char* data = malloc(dataSize);
+    if (!data)
+    {
+        return 0;
+    }
+
+    for (int i = 0; i < image->levelCount; ++i)
+    {
+        const ImageLevel* src = image->levels + i;
+        Bcn_CompressLevel(format, quality, image->data + src->offset, src->width, src->height,
+                          image->channelCount, data + levels[i].offset, threadCount);
+    }
+
+    free(image->data);
+    image->data = data;
+    image->dataSize = dataSize;
+    image->format = format;
+    memcpy(image->levels, levels, sizeof(ImageLevel) * image->levelCount);
+
+    return 1;
+}
+
+double Bcn_ComputePsnr(const Image* original, const Image* compressed, int level)
+{
+    const ImageLevel* src = original->levels + level;
+    const ImageLevel* dst = compressed->levels + level;
+    int channelCount = original->channelCount;
+
+    // Pairs of (source channel, decoded channel) that the format actually stores.
+    int pairs[4][2];
+    int pairCount = 0;
+    switch (compressed->format)
+    {
+        case ImageFormat_BC1:
+        case ImageFormat_BC3:
+            for (int c = 0; c < 3; ++c)
+            {
+                pairs[pairCount][0] = channelCount < 3 ? 0 : c;
+                pairs[pairCount][1] = c;
+                ++pairCount;
+            }
+            if (compressed->format == ImageFormat_BC3 && AlphaChannel(channelCount) >= 0)
+            {
+                pairs[pairCount][0] = AlphaChannel(channelCount);
+                pairs[pairCount][1] = 3;
+                ++pairCount;
+            }
+            break;
+        case ImageFormat_BC5:
+            pairs[pairCount][0] = channelCount > 1 ? 1 : 0;
+            pairs[pairCount][1] = 1;
+            ++pairCount;
+            // Fall through for the red channel.
+        case ImageFormat_BC4:
+            pairs[pairCount][0] = 0;
+            pairs[pairCount][1] = 0;
+            ++pairCount;
+            break;
+        default:
+            return 0.0;
+    }
+
+    unsigned char* rgba = malloc((size_t)dst->width * dst->height * 4);
+    assert(rgba);
+    Bcn_DecompressLevel(compressed->format, compressed->data + dst->offset, dst->width, dst->height, rgba);
+
+    double sum = 0.0;
+    size_t pixelCount = (size_t)src->width * src->height;
+    for (size_t i = 0; i < pixelCount; ++i)
+    {
+        for (int k = 0; k < pairCount; ++k)
+        {
+            double d = (double)original->data[src->offset + i * channelCount + pairs[k][0]] - rgba[i * 4 + pairs[k][1]];
+            sum += d * d;
+        }
+    }
+    free(rgba);
+
+    double mse = sum / (double)(pixelCount * pairCount);
+    return mse > 0.0 ? 10.0 * log10(255.0 * 255.0 / mse) : INFINITY;
+}
@@ -0,0 +1,63 @@
+#include "utils/glext.h"
+#include "utils/utils.h"
+
+#include <pthread.h>
+
+static GLExtensions extensions;
+static pthread_once_t extensionsOnce = PTHREAD_ONCE_INIT;
+static GLExtLoadProc loader;
+
+static void* GetProc(const char* name)
+{
+    return loader ? loader(name) : (void*)glfwGetProcAddress(name);
+}
+
+static int HasVersion(int major, int minor)
+{
+    return GLVersion.major > major || (GLVersion.major == major && GLVersion.minor >= minor);
+}
+
+static void LoadExtensions(void)
+{
+    if (HasVersion(4, 2) || Utils_HasExtension("GL_ARB_texture_storage"))
+    {
+        extensions.TexStorage2D = (GLExtTexStorage2DProc)GetProc("glTexStorage2D");
+        extensions.TexStorage3D = (GLExtTexStorage3DProc)GetProc("glTexStorage3D");
+        extensions.textureStorage = extensions.TexStorage2D && extensions.TexStorage3D;
+    }
+
+    if (HasVersion(4, 1) || Utils_HasExtension("GL_ARB_get_program_binary"))
+    {
+        GLint formatCount = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+        extensions.GetProgramBinary = (GLExtGetProgramBinaryProc)GetProc("glGetProgramBinary");
+        extensions.ProgramBinary = (GLExtProgramBinaryProc)GetProc("glProgramBinary");
+        extensions.ProgramParameteri = (GLExtProgramParameteriProc)GetProc("glProgramParameteri");
+        extensions.programBinary = formatCount > 0 && extensions.GetProgramBinary && extensions.ProgramBinary &&
+                                   extensions.ProgramParameteri;
+    }
+
+    if (Utils_HasExtension("GL_KHR_parallel_shader_compile"))
+    {
+        extensions.MaxShaderCompilerThreads =
+            (GLExtMaxShaderCompilerThreadsProc)GetProc("glMaxShaderCompilerThreadsKHR");
+    }
+    else if (Utils_HasExtension("GL_ARB_parallel_shader_compile"))
+    {
+        extensions.MaxShaderCompilerThreads =
+            (GLExtMaxShaderCompilerThreadsProc)GetProc("glMaxShaderCompilerThreadsARB");
+    }
+    extensions.parallelShaderCompile = extensions.MaxShaderCompilerThreads != NULL;
+}
+
+// Must be called before the first GLExt_Get.
+void GLExt_SetLoader(GLExtLoadProc load)
+{
+    loader = load;
+}
+
+const GLExtensions* GLExt_Get(void)
+{
+    pthread_once(&extensionsOnce, LoadExtensions);
+    return &extensions;
+}
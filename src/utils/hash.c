@@ -0,0 +1,291 @@
+#include "utils/hash.h"
+
+#include <string.h>
+
+// XXH64: four independent 64-bit lanes over 32-byte stripes, then a short tail.
+#define PRIME1 0x9E3779B185EBCA87ULL
+#define PRIME2 0xC2B2AE3D27D4EB4FULL
+#define PRIME3 0x165667B19E3779F9ULL
+#define PRIME4 0x85EBCA77C2B2AE63ULL
+#define PRIME5 0x27D4EB2F165667C5ULL
+
+static inline uint64_t RotateLeft(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t Read64(const unsigned char* p)
+{
+    uint64_t result;
+    memcpy(&result, p, sizeof(result));
+    return result;
+}
+
+static inline uint32_t Read32(const unsigned char* p)
+{
+    uint32_t result;
+    memcpy(&result, p, sizeof(result));
+    return result;
+}
+
+static inline uint64_t Round(uint64_t acc, uint64_t input)
+{
+    acc += input * PRIME2;
+    acc = RotateLeft(acc, 31);
+    return acc * PRIME1;
+}
+
+static inline uint64_t MergeRound(uint64_t acc, uint64_t lane)
+{
+    acc ^= Round(0, lane);
+    return acc * PRIME1 + PRIME4;
+}
+
+static inline uint64_t Avalanche(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= PRIME2;
+    x ^= x >> 29;
+    x *= PRIME3;
+    x ^= x >> 32;
+    return x;
+}
+
+uint64_t Hash_Bytes(const void* data, size_t size, uint64_t seed)
+{
+    const unsigned char* p = data;
+    const unsigned char* end = p + size;
+    uint64_t result;
+
+    if (size >= 32)
+    {
+        uint64_t v1 = seed + PRIME1 + PRIME2;
+        uint64_t v2 = seed + PRIME2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - PRIME1;
+        const unsigned char* limit = end - 32;
+
+        do
+        {
+            v1 = Round(v1, Read64(p));
+            v2 = Round(v2, Read64(p + 8));
+            v3 = Round(v3, Read64(p + 16));
+            v4 = Round(v4, Read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+
+        result = RotateLeft(v1, 1) + RotateLeft(v2, 7) + RotateLeft(v3, 12) + RotateLeft(v4, 18);
+        result = MergeRound(result, v1);
+        result = MergeRound(result, v2);
+        result = MergeRound(result, v3);
+        result = MergeRound(result, v4);
+    }
+    else
+    {
+        result = seed + PRIME5;
+    }
+
+    result += (uint64_t)size;
+
+    while (p + 8 <= end)
+    {
+        result ^= Round(0, Read64(p));
+        result = RotateLeft(result, 27) * PRIME1 + PRIME4;
+        p += 8;
+    }
+    if (p + 4 <= end)
+    {
+        result ^= (uint64_t)Read32(p) * PRIME1;
+        result = RotateLeft(result, 23) * PRIME2 + PRIME3;
+        p += 4;
+    }
+    while (p < end)
+    {
+        result ^= (*p) * PRIME5;
+        result = RotateLeft(result, 11) * PRIME1;
+        ++p;
+    }
+
+    return Avalanche(result);
+}
+
+uint64_t Hash_String(const char* text, uint64_t seed)
+{
+    return Hash_Bytes(text, strlen(text), seed);
+}
+
+// Hash_Wide: eight 64-bit lanes over 64-byte stripes using the XXH3 accumulate step
+// (a 32x32->64 multiply plus the swapped input), which SSE2 and NEON run two lanes
+// at a time. Lanes are scrambled every block. Not XXH3 compatible, but every code
+// path below produces the same value.
+#define WIDE_LANES 8
+#define WIDE_STRIPE 64
+#define WIDE_STRIPES_PER_BLOCK 16
+#define WIDE_PRIME32 0x9E3779B1U
+
+static const uint64_t WideKey[WIDE_LANES] =
+{
+    0xBE4BA423396CFEB8ULL, 0x1CAD21F72C81017CULL, 0xDB979083E96DD4DEULL, 0x1F67B3B7A4A44072ULL,
+    0x78E5C0CC4EE679CBULL, 0x2172FFCC7DD05A82ULL, 0x8E2443F7744608B8ULL, 0x4C263A81E69035E0ULL,
+};
+
+static const uint64_t WideScrambleKey[WIDE_LANES] =
+{
+    0xCB00C391BB52283CULL, 0xA32E531B8B65D088ULL, 0x4EF90DA297486471ULL, 0xD8ACDEA946EF1938ULL,
+    0x3F349CE33F76FAA8ULL, 0x1D4F0BC7C7BBDCF9ULL, 0x3159B4CD4BE0518AULL, 0x647378D9C97E9FC8ULL,
+};
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+
+static void AccumulateStripes(uint64_t acc[WIDE_LANES], const unsigned char* p, size_t stripeCount,
+                              const uint64_t key[WIDE_LANES])
+{
+    __m128i lanes[4];
+    __m128i keys[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        lanes[i] = _mm_loadu_si128((const __m128i*)acc + i);
+        keys[i] = _mm_loadu_si128((const __m128i*)key + i);
+    }
+
+    for (size_t s = 0; s < stripeCount; ++s, p += WIDE_STRIPE)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            __m128i value = _mm_loadu_si128((const __m128i*)p + i);
+            __m128i mixed = _mm_xor_si128(value, keys[i]);
+            __m128i product = _mm_mul_epu32(mixed, _mm_shuffle_epi32(mixed, _MM_SHUFFLE(0, 3, 0, 1)));
+            __m128i swapped = _mm_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2));
+            lanes[i] = _mm_add_epi64(lanes[i], _mm_add_epi64(product, swapped));
+        }
+    }
+
+    for (int i = 0; i < 4; ++i)
+    {
+        _mm_storeu_si128((__m128i*)acc + i, lanes[i]);
+    }
+}
+
+static void ScrambleLanes(uint64_t acc[WIDE_LANES])
+{
+    __m128i prime = _mm_set1_epi32((int)WIDE_PRIME32);
+    for (int i = 0; i < 4; ++i)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i*)acc + i);
+        x = _mm_xor_si128(x, _mm_srli_epi64(x, 47));
+        x = _mm_xor_si128(x, _mm_loadu_si128((const __m128i*)WideScrambleKey + i));
+        // 64x32 multiply from two 32x32->64 halves.
+        __m128i low = _mm_mul_epu32(x, prime);
+        __m128i high = _mm_mul_epu32(_mm_srli_epi64(x, 32), prime);
+        _mm_storeu_si128((__m128i*)acc + i, _mm_add_epi64(low, _mm_slli_epi64(high, 32)));
+    }
+}
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+
+static void AccumulateStripes(uint64_t acc[WIDE_LANES], const unsigned char* p, size_t stripeCount,
+                              const uint64_t key[WIDE_LANES])
+{
+    uint64x2_t lanes[4];
+    uint64x2_t keys[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        lanes[i] = vld1q_u64(acc + i * 2);
+        keys[i] = vld1q_u64(key + i * 2);
+    }
+
+    for (size_t s = 0; s < stripeCount; ++s, p += WIDE_STRIPE)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            uint64x2_t value = vreinterpretq_u64_u8(vld1q_u8(p + i * 16));
+            uint64x2_t mixed = veorq_u64(value, keys[i]);
+            uint64x2_t product = vmull_u32(vmovn_u64(mixed), vshrn_n_u64(mixed, 32));
+            uint64x2_t swapped = vextq_u64(value, value, 1);
+            lanes[i] = vaddq_u64(lanes[i], vaddq_u64(product, swapped));
+        }
+    }
+
+    for (int i = 0; i < 4; ++i)
+    {
+        vst1q_u64(acc + i * 2, lanes[i]);
+    }
+}
+
+static void ScrambleLanes(uint64_t acc[WIDE_LANES])
+{
+    uint32x2_t prime = vdup_n_u32(WIDE_PRIME32);
+    for (int i = 0; i < 4; ++i)
+    {
+        uint64x2_t x = vld1q_u64(acc + i * 2);
+        x = veorq_u64(x, vshrq_n_u64(x, 47));
+        x = veorq_u64(x, vld1q_u64(WideScrambleKey + i * 2));
+        uint64x2_t low = vmull_u32(vmovn_u64(x), prime);
+        uint64x2_t high = vmull_u32(vshrn_n_u64(x, 32), prime);
+        vst1q_u64(acc + i * 2, vaddq_u64(low, vshlq_n_u64(high, 32)));
+    }
+}
+#else
+static void AccumulateStripes(uint64_t acc[WIDE_LANES], const unsigned char* p, size_t stripeCount,
+                              const uint64_t key[WIDE_LANES])
+{
+    for (size_t s = 0; s < stripeCount; ++s, p += WIDE_STRIPE)
+    {
+        for (int i = 0; i < WIDE_LANES; ++i)
+        {
+            uint64_t value = Read64(p + i * 8);
+            uint64_t mixed = value ^ key[i];
+            acc[i ^ 1] += value;
+            acc[i] += (mixed & 0xFFFFFFFFULL) * (mixed >> 32);
+        }
+    }
+}
+
+static void ScrambleLanes(uint64_t acc[WIDE_LANES])
+{
+    for (int i = 0; i < WIDE_LANES; ++i)
+    {
+        uint64_t x = acc[i];
+        x ^= x >> 47;
+        x ^= WideScrambleKey[i];
+        acc[i] = x * WIDE_PRIME32;
+    }
+}
+#endif
+
+uint64_t Hash_Wide(const void* data, size_t size, uint64_t seed)
+{
+    // Below a block the lane setup costs more than it saves.
+    if (size < WIDE_STRIPE * WIDE_STRIPES_PER_BLOCK)
+    {
+        return Hash_Bytes(data, size, seed);
+    }
+
+    uint64_t key[WIDE_LANES];
+    for (int i = 0; i < WIDE_LANES; ++i)
+    {
+        key[i] = (i & 1) ? WideKey[i] - seed : WideKey[i] + seed;
+    }
+    uint64_t acc[WIDE_LANES] = {WIDE_PRIME32, PRIME1, PRIME2, PRIME3, PRIME4, PRIME5, ~seed, seed};
+
+    const unsigned char* p = data;
+    size_t stripeCount = size / WIDE_STRIPE;
+    while (stripeCount >= WIDE_STRIPES_PER_BLOCK)
+    {
+        AccumulateStripes(acc, p, WIDE_STRIPES_PER_BLOCK, key);
+        ScrambleLanes(acc);
+        p += WIDE_STRIPE * WIDE_STRIPES_PER_BLOCK;
+        stripeCount -= WIDE_STRIPES_PER_BLOCK;
+    }
+    AccumulateStripes(acc, p, stripeCount, key);
+    p += stripeCount * WIDE_STRIPE;
+
+    uint64_t result = (uint64_t)size * PRIME1 ^ Hash_Bytes(p, size % WIDE_STRIPE, seed);
+    for (int i = 0; i < WIDE_LANES; ++i)
+    {
+        result ^= Round(0, acc[i]);
+        result = RotateLeft(result, 27) * PRIME1 + PRIME4;
+    }
+    return Avalanche(result);
+}
@@ -0,0 +1,352 @@
+#include "utils/hotreload.h"
+#include "utils/utils.h"
+#include "utils/shaderfiles.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/inotify.h>
+#endif
+
+// Without inotify, how often modification times are checked.
+#define HOTRELOAD_POLL_SECONDS 0.25
+
+static char* CopyString(const char* text)
+{
+    size_t size = strlen(text) + 1;
+    char* result = malloc(size);
+    assert(result);
+    memcpy(result, text, size);
+    return result;
+}
+
+static const char* BaseName(const char* path)
+{
+    const char* slash = strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+
+static long long ModificationTime(const char* path)
+{
+    struct stat info;
+    return stat(path, &info) ? 0 : (long long)info.st_mtime;
+}
+
+// Includes are only known to the preprocessor, so it compares every file a program
+// pulled in against what it was built from.
+static void MarkStale(HotReload* reload)
+{
+    for (int i = 0; i < reload->programCount; ++i)
+    {
+        ReloadProgram* entry = reload->programs + i;
+        if (Preprocessor_IsStale(reload->preprocessor, entry->paths[0]) ||
+            Preprocessor_IsStale(reload->preprocessor, entry->paths[1]))
+        {
+            entry->dirty = 1;
+        }
+    }
+}
+
+static void PollModificationTimes(HotReload* reload)
+{
+    double now = glfwGetTime();
+    if (now - reload->lastPollTime < HOTRELOAD_POLL_SECONDS)
+    {
+        return;
+    }
+    reload->lastPollTime = now;
+
+    if (reload->preprocessor)
+    {
+        MarkStale(reload);
+        return;
+    }
+
+    for (int i = 0; i < reload->programCount; ++i)
+    {
+        ReloadProgram* entry = reload->programs + i;
+        for (int j = 0; j < 2; ++j)
+        {
+            long long mtime = ModificationTime(entry->paths[j]);
+            if (mtime && mtime != entry->mtimes[j])
+            {
+                entry->mtimes[j] = mtime;
+                entry->dirty = 1;
+            }
+        }
+    }
+}
+
+#if defined(__linux__)
+// Editors often save by renaming a new file over the old one, which a watch on the
+// file itself would miss, so the containing directory is watched instead.
+static int WatchFile(HotReload* reload, const char* path)
+{
+    if (reload->inotifyFd < 0)
+    {
+        return -1;
+    }
+
+    const char* name = BaseName(path);
+    char directory[1024] = ".";
+    if (name != path)
+    {
+        size_t length = (size_t)(name - path);
+        if (length >= sizeof(directory))
+        {
+            return -1;
+        }
+        memcpy(directory, path, length);
+        directory[length] = '\0';
+    }
+    // Adding the same directory again returns the existing descriptor.
+    return inotify_add_watch(reload->inotifyFd, directory, IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+}
+
+static void MarkChanged(HotReload* reload, int watch, const char* name)
+{
+    for (int i = 0; i < reload->programCount; ++i)
+    {
+        ReloadProgram* entry = reload->programs + i;
+        for (int j = 0; j < 2; ++j)
+        {
+            if (entry->watches[j] == watch && strcmp(BaseName(entry->paths[j]), name) == 0)
+            {
+                entry->dirty = 1;
+            }
+        }
+    }
+}
+
+static void CollectChanges(HotReload* reload)
+{
+    if (reload->inotifyFd < 0)
+    {
+        PollModificationTimes(reload);
+        return;
+    }
+
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    int changed = 0;
+    for (;;)
+    {
+        ssize_t length = read(reload->inotifyFd, buffer, sizeof(buffer));
+        if (length <= 0)
+        {
+            break;
+        }
+        for (char* p = buffer; p < buffer + length;)
+        {
+            const struct inotify_event* event = (const struct inotify_event*)p;
+            if (event->len)
+            {
+                MarkChanged(reload, event->wd, event->name);
+                changed = 1;
+            }
+            p += sizeof(struct inotify_event) + event->len;
+        }
+    }
+
+    if (changed && reload->preprocessor)
+    {
+        MarkStale(reload);
+    }
+}
+#else
+static int WatchFile(HotReload* reload, const char* path)
+{
+    return -1;
+}
+
+static void CollectChanges(HotReload* reload)
+{
+    PollModificationTimes(reload);
+}
+#endif
+
+// Includes may live in directories nothing else watches.
+static void WatchDependencies(HotReload* reload, const ShaderExpansion* expansion)
+{
+    for (int i = 0; expansion && i < expansion->dependencyCount; ++i)
+    {
+        WatchFile(reload, expansion->dependencies[i].path);
+    }
+}
+
+static void StartPreprocessedBuild(HotReload* reload, ReloadProgram* entry)
+{
+    // Failures were reported by the preprocessor; the next change event retries.
+    const ShaderExpansion* vert = Preprocessor_Expand(reload->preprocessor, entry->paths[0]);
+    const ShaderExpansion* frag = Preprocessor_Expand(reload->preprocessor, entry->paths[1]);
+    if (!vert || !frag)
+    {
+        return;
+    }
+
+    ShaderBatch_Init(&entry->batch, NULL, reload->onError, reload->userData);
+    ShaderBatch_Add(&entry->batch, entry->name, vert->text, frag->text);
+    ShaderBatch_Submit(&entry->batch);
+    entry->building = 1;
+
+    WatchDependencies(reload, vert);
+    WatchDependencies(reload, frag);
+}
+
+static void StartBuild(HotReload* reload, ReloadProgram* entry)
+{
+    if (reload->preprocessor)
+    {
+        StartPreprocessedBuild(reload, entry);
+        return;
+    }
+
+    char* vertSrc = ShaderFiles_Read(entry->paths[0]);
+    char* fragSrc = ShaderFiles_Read(entry->paths[1]);
+    if (vertSrc && fragSrc)
+    {
+        ShaderBatch_Init(&entry->batch, NULL, reload->onError, reload->userData);
+        ShaderBatch_Add(&entry->batch, entry->name, vertSrc, fragSrc);
+        ShaderBatch_Submit(&entry->batch);
+        entry->building = 1;
+    }
+    else if (reload->onError)
+    {
+        // Usually caught mid-save; the next change event retries.
+        reload->onError(vertSrc ? entry->paths[1] : entry->paths[0], "read", "could not read file", reload->userData);
+    }
+    free(vertSrc);
+    free(fragSrc);
+}
+
+static void FinishBuild(ReloadProgram* entry)
+{
+    GLuint program = ShaderBatch_Take(&entry->batch, 0);
+    ShaderBatch_Free(&entry->batch);
+    entry->building = 0;
+
+    if (program)
+    {
+        glDeleteProgram(entry->program);
+        entry->program = program;
+        ProgramInfo_Free(&entry->info);
+        ProgramInfo_Init(&entry->info, program);
+        ++entry->generation;
+    }
+}
+
+// preprocessor may be NULL to read the files as they are; it must outlive the reloader.
+void HotReload_Init(HotReload* reload, Preprocessor* preprocessor, ShaderErrorFunc onError, void* userData)
+{
+    memset(reload, 0, sizeof(*reload));
+    reload->preprocessor = preprocessor;
+    reload->onError = onError;
+    reload->userData = userData;
+#if defined(__linux__)
+    reload->inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#else
+    reload->inotifyFd = -1;
+#endif
+}
+
+// Deletes the current programs too.
+void HotReload_Free(HotReload* reload)
+{
+    for (int i = 0; i < reload->programCount; ++i)
+    {
+        ReloadProgram* entry = reload->programs + i;
+        if (entry->building)
+        {
+            ShaderBatch_Free(&entry->batch);
+        }
+        glDeleteProgram(entry->program);
+        ProgramInfo_Free(&entry->info);
+        free(entry->paths[0]);
+        free(entry->paths[1]);
+        free(entry->name);
+    }
+    if (reload->inotifyFd >= 0)
+    {
+        close(reload->inotifyFd);
+    }
+    free(reload->programs);
+    memset(reload, 0, sizeof(*reload));
+}
+
+// Takes ownership of program, built from the two files. Returns a handle.
+int HotReload_Add(HotReload* reload, const char* vertPath, const char* fragPath, GLuint program)
+{
+    if (reload->programCount == reload->programCapacity)
+    {
+        reload->programCapacity = reload->programCapacity ? reload->programCapacity * 2 : 8;
+        reload->programs = realloc(reload->programs, reload->programCapacity * sizeof(ReloadProgram));
+        assert(reload->programs);
+    }
+
+    ReloadProgram* entry = reload->programs + reload->programCount;
+    memset(entry, 0, sizeof(*entry));
+    entry->paths[0] = CopyString(vertPath);
+    entry->paths[1] = CopyString(fragPath);
+    size_t nameSize = strlen(vertPath) + strlen(fragPath) + 3;
+    entry->name = malloc(nameSize);
+    assert(entry->name);
+    snprintf(entry->name, nameSize, "%s, %s", vertPath, fragPath);
+    entry->program = program;
+    ProgramInfo_Init(&entry->info, program);
+    for (int i = 0; i < 2; ++i)
+    {
+        entry->watches[i] = WatchFile(reload, entry->paths[i]);
+        entry->mtimes[i] = ModificationTime(entry->paths[i]);
+        if (reload->preprocessor)
+        {
+            WatchDependencies(reload, Preprocessor_Expand(reload->preprocessor, entry->paths[i]));
+        }
+    }
+
+    return reload->programCount++;
+}
+
+// Once per frame. Never blocks on the driver when parallel shader compile is available.
+void HotReload_Update(HotReload* reload)
+{
+    CollectChanges(reload);
+
+    for (int i = 0; i < reload->programCount; ++i)
+    {
+        ReloadProgram* entry = reload->programs + i;
+        if (entry->building)
+        {
+            if (!ShaderBatch_Poll(&entry->batch))
+            {
+                FinishBuild(entry);
+            }
+        }
+        else if (entry->dirty)
+        {
+            // Changes that land mid-build are picked up by the next one.
+            entry->dirty = 0;
+            StartBuild(reload, entry);
+        }
+    }
+}
+
+GLuint HotReload_Program(const HotReload* reload, int handle)
+{
+    return reload->programs[handle].program;
+}
+
+int HotReload_Generation(const HotReload* reload, int handle)
+{
+    return reload->programs[handle].generation;
+}
+
+// Reflection of the current program; replaced on every swap.
+ProgramInfo* HotReload_Info(HotReload* reload, int handle)
+{
+    return &reload->programs[handle].info;
+}
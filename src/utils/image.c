@@ -0,0 +1,315 @@
+#include "utils/image.h"
+#include "utils/mipmap.h"
+#include "utils/bcn.h"
+#include "utils/utils.h"
+#include "utils/glext.h"
+#include "utils/hash.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "utils/stb_image.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+static GLenum FormatFromChannelCount(int channelCount)
+{
+    switch (channelCount)
+    {
+        case 1: return GL_RED;
+        case 2: return GL_RG;
+        case 3: return GL_RGB;
+        default: return GL_RGBA;
+    }
+}
+
+static GLenum InternalFormat(const Image* image)
+{
+    if (image->format != ImageFormat_Uncompressed)
+    {
+        return Bcn_GLFormat(image->format);
+    }
+
+    switch (image->channelCount)
+    {
+        case 1: return GL_R8;
+        case 2: return GL_RG8;
+        case 3: return GL_RGB8;
+        default: return GL_RGBA8;
+    }
+}
+
+// Largest alignment the tightly packed rows of this level satisfy, so drivers can copy rows directly.
+static int RowAlignment(const Image* image, const ImageLevel* level)
+{
+    if (image->format != ImageFormat_Uncompressed)
+    {
+        return 4;
+    }
+
+    size_t pitch = (size_t)level->width * image->channelCount;
+    size_t address = (size_t)(image->data + level->offset);
+    for (int alignment = 8; alignment > 1; alignment >>= 1)
+    {
+        if (pitch % alignment == 0 && address % alignment == 0)
+        {
+            return alignment;
+        }
+    }
+    return 1;
+}
+
+int Image_Load(const char* fileName, int flags, Image* image)
+{
+    size_t size;
+    unsigned char* bytes = Utils_ReadBinaryFile(fileName, &size);
+    if (!bytes)
+    {
+        memset(image, 0, sizeof(*image));
+        return 0;
+    }
+
+    int result = Image_LoadFromMemory(bytes, size, flags, image);
+    free(bytes);
+    return result;
+}
+
+int Image_LoadFromMemory(const unsigned char* bytes, size_t size, int flags, Image* image)
+{
+    memset(image, 0, sizeof(*image));
+
+    // RGB is widened to RGBA: four-byte texels upload without the driver repacking rows.
+    int w, h, channelCount;
+    if (!stbi_info_from_memory(bytes, (int)size, &w, &h, &channelCount))
+    {
+        return 0;
+    }
+    int desiredChannelCount = channelCount == 3 ? 4 : 0;
+    unsigned char* pixels = stbi_load_from_memory(bytes, (int)size, &w, &h, &channelCount, desiredChannelCount);
+    if (!pixels)
+    {
+        return 0;
+    }
+    if (desiredChannelCount)
+    {
+        channelCount = desiredChannelCount;
+    }
+
+    // Copied out so the chain can grow with realloc independently of stb's allocator.
+    size_t pixelSize = (size_t)w * h * channelCount;
+    image->data = malloc(pixelSize);
+    if (!image->data)
+    {
+        stbi_image_free(pixels);
+        return 0;
+    }
+    memcpy(image->data, pixels, pixelSize);
+    stbi_image_free(pixels);
+
+    image->width = w;
+    image->height = h;
+    image->channelCount = channelCount;
+    image->flags = flags;
+    image->levelCount = 1;
+    image->levels[0].width = w;
+    image->levels[0].height = h;
+    image->levels[0].offset = 0;
+    image->levels[0].size = pixelSize;
+    image->dataSize = pixelSize;
+
+    if ((flags & IMAGE_FLAG_MIPMAPS) && !Mip_GenerateChain(image, MipFilter_Kaiser))
+    {
+        Image_Free(image);
+        return 0;
+    }
+
+    return 1;
+}
+
+void Image_Free(Image* image)
+{
+    if (image->mapping)
+    {
+        munmap(image->mapping, image->mappingSize);
+    }
+    else
+    {
+        free(image->data);
+    }
+    memset(image, 0, sizeof(*image));
+}
+
+// Identical hashes mean identical textures: the layout seeds the hash of every level's bytes.
+uint64_t Image_HashPixels(const Image* image)
+{
+    int layout[] = {image->width, image->height, image->channelCount, image->flags, image->format, image->levelCount};
+    uint64_t seed = Hash_Bytes(layout, sizeof(layout), 0);
+    return Hash_Wide(image->data, image->dataSize, seed);
+}
+
+GLuint Image_CreateTexture(const Image* image)
+{
+    const GLExtensions* extensions = GLExt_Get();
+
+    GLuint result;
+    glGenTextures(1, &result);
+    glBindTexture(GL_TEXTURE_2D, result);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, image->levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, image->levelCount - 1);
+
+    // Storage first, pixels second, so cached images go straight from the mapping into the texture.
+    if (extensions->textureStorage)
+    {
+        // Immutable storage: the driver validates the chain once instead of on every draw.
+        extensions->TexStorage2D(GL_TEXTURE_2D, image->levelCount, InternalFormat(image), image->width, image->height);
+    }
+    else
+    {
+        GLenum format = FormatFromChannelCount(image->channelCount);
+        for (int i = 0; i < image->levelCount; ++i)
+        {
+            const ImageLevel* level = image->levels + i;
+            if (image->format == ImageFormat_Uncompressed)
+            {
+                glTexImage2D(GL_TEXTURE_2D, i, InternalFormat(image), level->width, level->height, 0,
+                             format, GL_UNSIGNED_BYTE, NULL);
+            }
+            else
+            {
+                glCompressedTexImage2D(GL_TEXTURE_2D, i, InternalFormat(image), level->width, level->height, 0,
+                                       (GLsizei)level->size, NULL);
+            }
+        }
+    }
+    Image_UploadLevels(image, GL_TEXTURE_2D);
+
+    return result;
+}
+
+void Image_UploadLevels(const Image* image, GLenum target)
+{
+    GLenum format = FormatFromChannelCount(image->channelCount);
+
+    for (int i = 0; i < image->levelCount; ++i)
+    {
+        const ImageLevel* level = image->levels + i;
+        glPixelStorei(GL_UNPACK_ALIGNMENT, RowAlignment(image, level));
+        if (image->format == ImageFormat_Uncompressed)
+        {
+            glTexSubImage2D(target, i, 0, 0, level->width, level->height,
+                            format, GL_UNSIGNED_BYTE, image->data + level->offset);
+        }
+        else
+        {
+            glCompressedTexSubImage2D(target, i, 0, 0, level->width, level->height, InternalFormat(image),
+                                      (GLsizei)level->size, image->data + level->offset);
+        }
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+// Defines a single level of the bound mutable texture, storage and pixels together.
+void Image_DefineLevel(const Image* image, GLenum target, int index)
+{
+    const ImageLevel* level = image->levels + index;
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, RowAlignment(image, level));
+    if (image->format == ImageFormat_Uncompressed)
+    {
+        GLenum format = FormatFromChannelCount(image->channelCount);
+        glTexImage2D(target, index, InternalFormat(image), level->width, level->height, 0,
+                     format, GL_UNSIGNED_BYTE, image->data + level->offset);
+    }
+    else
+    {
+        glCompressedTexImage2D(target, index, InternalFormat(image), level->width, level->height, 0,
+                               (GLsizei)level->size, image->data + level->offset);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+static int IsSameLayout(const Image* a, const Image* b)
+{
+    return a->width == b->width && a->height == b->height && a->channelCount == b->channelCount &&
+           a->format == b->format && a->levelCount == b->levelCount;
+}
+
+// One GL_TEXTURE_2D_ARRAY with a layer per image; every image must share size, format and mip count.
+GLuint Image_CreateTextureArray(const Image* images, int count)
+{
+    if (count <= 0)
+    {
+        return 0;
+    }
+    for (int i = 1; i < count; ++i)
+    {
+        if (!IsSameLayout(images, images + i))
+        {
+            return 0;
+        }
+    }
+
+    const GLExtensions* extensions = GLExt_Get();
+    const Image* first = images;
+    GLenum format = FormatFromChannelCount(first->channelCount);
+
+    GLuint result;
+    glGenTextures(1, &result);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, result);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, first->levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, first->levelCount - 1);
+
+    if (extensions->textureStorage)
+    {
+        extensions->TexStorage3D(GL_TEXTURE_2D_ARRAY, first->levelCount, InternalFormat(first),
+                                 first->width, first->height, count);
+    }
+    else
+    {
+        for (int i = 0; i < first->levelCount; ++i)
+        {
+            const ImageLevel* level = first->levels + i;
+            if (first->format == ImageFormat_Uncompressed)
+            {
+                glTexImage3D(GL_TEXTURE_2D_ARRAY, i, InternalFormat(first), level->width, level->height, count, 0,
+                             format, GL_UNSIGNED_BYTE, NULL);
+            }
+            else
+            {
+                glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, i, InternalFormat(first), level->width, level->height, count, 0,
+                                       (GLsizei)(level->size * count), NULL);
+            }
+        }
+    }
+
+    for (int layer = 0; layer < count; ++layer)
+    {
+        const Image* image = images + layer;
+        for (int i = 0; i < image->levelCount; ++i)
+        {
+            const ImageLevel* level = image->levels + i;
+            glPixelStorei(GL_UNPACK_ALIGNMENT, RowAlignment(image, level));
+            if (image->format == ImageFormat_Uncompressed)
+            {
+                glTexSubImage3D(GL_TEXTURE_2D_ARRAY, i, 0, 0, layer, level->width, level->height, 1,
+                                format, GL_UNSIGNED_BYTE, image->data + level->offset);
+            }
+            else
+            {
+                glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, i, 0, 0, layer, level->width, level->height, 1,
+                                          InternalFormat(image), (GLsizei)level->size, image->data + level->offset);
+            }
+        }
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    return result;
+}
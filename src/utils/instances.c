@@ -0,0 +1,92 @@
+#include "utils/instances.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+// capacity is the most instances one update may hold.
+void InstanceBuffer_Init(InstanceBuffer* instances, GLsizei instanceSize, const MeshAttribute* attributes,
+                         int attributeCount, int capacity)
+{
+    memset(instances, 0, sizeof(*instances));
+    assert(attributeCount <= MESHPOOL_MAX_ATTRIBUTES);
+    instances->instanceSize = instanceSize;
+    memcpy(instances->attributes, attributes, attributeCount * sizeof(MeshAttribute));
+    instances->attributeCount = attributeCount;
+    instances->capacity = capacity;
+
+    glGenBuffers(1, &instances->buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, instances->buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)capacity * instanceSize, NULL, GL_DYNAMIC_DRAW);
+}
+
+void InstanceBuffer_Free(InstanceBuffer* instances)
+{
+    glDeleteBuffers(1, &instances->buffer);
+    memset(instances, 0, sizeof(*instances));
+}
+
+// Replaces every instance; returns how many were kept, at most the capacity.
+int InstanceBuffer_Update(InstanceBuffer* instances, const void* data, int count)
+{
+    if (count > instances->capacity)
+    {
+        count = instances->capacity;
+    }
+
+    // Invalidating the whole buffer lets the driver hand out fresh storage instead of
+    // waiting for draws still reading the previous instances, and only the written
+    // range is mapped.
+    if (count > 0)
+    {
+        GLsizeiptr size = (GLsizeiptr)count * instances->instanceSize;
+        glBindBuffer(GL_COPY_WRITE_BUFFER, instances->buffer);
+        void* mapped = glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (!mapped)
+        {
+            count = 0;
+        }
+        else
+        {
+            memcpy(mapped, data, (size_t)size);
+            glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        }
+    }
+    instances->instanceCount = count;
+    ++instances->uploadCount;
+    return count;
+}
+
+// Adds the instance attributes to vao, which is left bound.
+void InstanceBuffer_Attach(const InstanceBuffer* instances, GLuint vao)
+{
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, instances->buffer);
+    for (int i = 0; i < instances->attributeCount; ++i)
+    {
+        const MeshAttribute* attribute = instances->attributes + i;
+        glVertexAttribPointer(attribute->index, attribute->size, attribute->type, attribute->normalized,
+                              instances->instanceSize, (void*)(uintptr_t)attribute->offset);
+        glVertexAttribDivisor(attribute->index, 1);
+        glEnableVertexAttribArray(attribute->index);
+    }
+}
+
+// Attaches to every page the pool has now; pages created by later adds need another call.
+void InstanceBuffer_AttachPool(const InstanceBuffer* instances, MeshPool* pool)
+{
+    for (int i = 0; i < pool->pageCount; ++i)
+    {
+        InstanceBuffer_Attach(instances, pool->pages[i].vao);
+    }
+    pool->boundPage = -1;
+}
+
+// Draws every instance of the non-indexed geometry in the bound VAO.
+void InstanceBuffer_DrawArrays(const InstanceBuffer* instances, GLenum mode, GLint first, GLsizei count)
+{
+    if (instances->instanceCount > 0)
+    {
+        glDrawArraysInstanced(mode, first, count, instances->instanceCount);
+    }
+}
@@ -0,0 +1,208 @@
+#include "utils/loader.h"
+#include "utils/hash.h"
+#include "utils/utils.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#define LOADER_MAX_THREADS 16
+
+struct Loader
+{
+    pthread_t threads[LOADER_MAX_THREADS];
+    int threadCount;
+    // Cores left to each loader thread for block compressing one image.
+    int compressThreadCount;
+    pthread_mutex_t mutex;
+    pthread_cond_t jobAdded;
+    pthread_cond_t jobDone;
+    ImageJob* head;
+    ImageJob* tail;
+    int quit;
+};
+
+// The same bytes cooked with different options are different textures.
+static uint64_t SourceHash(const ImageJob* job, uint64_t contentHash)
+{
+    uint64_t options = (uint64_t)job->flags | ((uint64_t)job->format << 16) | ((uint64_t)job->quality << 32);
+    return Hash_Bytes(&options, sizeof(options), contentHash);
+}
+
+static int LoadImage(const Loader* loader, ImageJob* job, int* cacheHit, uint64_t* contentHash)
+{
+    if (job->cacheDir)
+    {
+        return TexCache_Load(job->cacheDir, job->fileName, job->flags, job->format, job->quality,
+                             loader->compressThreadCount, &job->image, cacheHit, contentHash);
+    }
+
+    size_t size;
+    unsigned char* bytes = Utils_ReadBinaryFile(job->fileName, &size);
+    if (!bytes)
+    {
+        memset(&job->image, 0, sizeof(job->image));
+        return 0;
+    }
+    *contentHash = Hash_Bytes(bytes, size, 0);
+    int success = Image_LoadFromMemory(bytes, size, job->flags, &job->image);
+    free(bytes);
+
+    if (success && job->format != ImageFormat_Uncompressed)
+    {
+        success = Bcn_CompressImage(&job->image, job->format, job->quality, loader->compressThreadCount);
+    }
+    return success;
+}
+
+static void* LoaderThread(void* param)
+{
+    Loader* loader = param;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&loader->mutex);
+        while (!loader->head && !loader->quit)
+        {
+            pthread_cond_wait(&loader->jobAdded, &loader->mutex);
+        }
+        if (!loader->head)
+        {
+            pthread_mutex_unlock(&loader->mutex);
+            break;
+        }
+        ImageJob* job = loader->head;
+        loader->head = job->next;
+        if (!loader->head)
+        {
+            loader->tail = NULL;
+        }
+        pthread_mutex_unlock(&loader->mutex);
+
+        // Decoding, the mip chain, block compression and hashing all happen here, off the GL thread.
+        int cacheHit = 0;
+        uint64_t contentHash = 0;
+        int success = LoadImage(loader, job, &cacheHit, &contentHash);
+        uint64_t sourceHash = success ? SourceHash(job, contentHash) : 0;
+        uint64_t pixelHash = success ? Image_HashPixels(&job->image) : 0;
+
+        // Read before publishing: a job without a callback may be freed as soon as it is done.
+        ImageJobDoneFunc onDone = job->onDone;
+        void* userData = job->userData;
+
+        pthread_mutex_lock(&loader->mutex);
+        job->success = success;
+        job->sourceHash = sourceHash;
+        job->pixelHash = pixelHash;
+        job->cacheHit = cacheHit;
+        job->done = 1;
+        pthread_cond_broadcast(&loader->jobDone);
+        pthread_mutex_unlock(&loader->mutex);
+
+        if (onDone)
+        {
+            onDone(job, userData);
+        }
+    }
+
+    return NULL;
+}
+
+Loader* Loader_Create(int threadCount)
+{
+    Loader* result = calloc(1, sizeof(Loader));
+    assert(result);
+
+    if (threadCount < 1)
+    {
+        threadCount = 1;
+    }
+    if (threadCount > LOADER_MAX_THREADS)
+    {
+        threadCount = LOADER_MAX_THREADS;
+    }
+    long coreCount = sysconf(_SC_NPROCESSORS_ONLN);
+    result->compressThreadCount = coreCount > threadCount ? (int)(coreCount / threadCount) : 1;
+
+    pthread_mutex_init(&result->mutex, NULL);
+    pthread_cond_init(&result->jobAdded, NULL);
+    pthread_cond_init(&result->jobDone, NULL);
+
+    for (int i = 0; i < threadCount; ++i)
+    {
+        if (pthread_create(result->threads + i, NULL, LoaderThread, result))
+        {
+            break;
+        }
+        ++result->threadCount;
+    }
+
+    if (!result->threadCount)
+    {
+        Loader_Destroy(result);
+        return NULL;
+    }
+
+    return result;
+}
+
+void Loader_Destroy(Loader* loader)
+{
+    pthread_mutex_lock(&loader->mutex);
+    loader->quit = 1;
+    pthread_cond_broadcast(&loader->jobAdded);
+    pthread_mutex_unlock(&loader->mutex);
+
+    for (int i = 0; i < loader->threadCount; ++i)
+    {
+        pthread_join(loader->threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&loader->jobDone);
+    pthread_cond_destroy(&loader->jobAdded);
+    pthread_mutex_destroy(&loader->mutex);
+    free(loader);
+}
+
+void Loader_Submit(Loader* loader, ImageJob* job)
+{
+    job->success = 0;
+    job->sourceHash = 0;
+    job->pixelHash = 0;
+    job->cacheHit = 0;
+    job->done = 0;
+    job->next = NULL;
+
+    pthread_mutex_lock(&loader->mutex);
+    if (loader->tail)
+    {
+        loader->tail->next = job;
+    }
+    else
+    {
+        loader->head = job;
+    }
+    loader->tail = job;
+    pthread_cond_signal(&loader->jobAdded);
+    pthread_mutex_unlock(&loader->mutex);
+}
+
+int Loader_IsDone(Loader* loader, ImageJob* job)
+{
+    pthread_mutex_lock(&loader->mutex);
+    int result = job->done;
+    pthread_mutex_unlock(&loader->mutex);
+    return result;
+}
+
+void Loader_Wait(Loader* loader, ImageJob* job)
+{
+    pthread_mutex_lock(&loader->mutex);
+    while (!job->done)
+    {
+        pthread_cond_wait(&loader->jobDone, &loader->mutex);
+    }
+    pthread_mutex_unlock(&loader->mutex);
+}
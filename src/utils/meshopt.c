@@ -0,0 +1,440 @@
+#include "utils/meshopt.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+
+#define FETCH_LINE_SIZE 64
+#define FETCH_LINE_COUNT 256
+
+// FIFO cache on timestamps: a vertex is cached while fewer than cacheSize misses have
+// happened since its own. Advancing time by cacheSize + 1 empties the cache.
+static int Touch(unsigned int* timestamps, unsigned int vertex, unsigned int* time, int cacheSize)
+{
+    if (*time - timestamps[vertex] > (unsigned int)cacheSize)
+    {
+        timestamps[vertex] = (*time)++;
+        return 1;
+    }
+    return 0;
+}
+
+void MeshOpt_CacheStats(const unsigned int* indices, int indexCount, int vertexCount, int vertexSize, int cacheSize,
+                        MeshCacheStats* stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    stats->triangleCount = indexCount / 3;
+    if (indexCount == 0)
+    {
+        return;
+    }
+
+    unsigned int* timestamps = calloc(vertexCount, sizeof(unsigned int));
+    unsigned char* referenced = calloc(vertexCount, 1);
+    size_t lines[FETCH_LINE_COUNT];
+    assert(timestamps && referenced);
+    memset(lines, 0xFF, sizeof(lines));
+
+    unsigned int time = (unsigned int)cacheSize + 1;
+    size_t fetchedBytes = 0;
+    for (int i = 0; i < stats->triangleCount * 3; ++i)
+    {
+        unsigned int vertex = indices[i];
+        assert(vertex < (unsigned int)vertexCount);
+        if (!referenced[vertex])
+        {
+            referenced[vertex] = 1;
+            ++stats->vertexCount;
+        }
+        if (!Touch(timestamps, vertex, &time, cacheSize))
+        {
+            continue;
+        }
+        ++stats->transformedVertices;
+
+        // The vertex shader's inputs come through a small direct-mapped cache.
+        size_t first = (size_t)vertex * vertexSize / FETCH_LINE_SIZE;
+        size_t last = ((size_t)vertex * vertexSize + vertexSize - 1) / FETCH_LINE_SIZE;
+        for (size_t line = first; line <= last; ++line)
+        {
+            if (lines[line % FETCH_LINE_COUNT] != line)
+            {
+                lines[line % FETCH_LINE_COUNT] = line;
+                fetchedBytes += FETCH_LINE_SIZE;
+            }
+        }
+    }
+
+    stats->acmr = (float)stats->transformedVertices / stats->triangleCount;
+    stats->atvr = (float)stats->transformedVertices / stats->vertexCount;
+    stats->overfetch = (float)fetchedBytes / ((size_t)stats->vertexCount * vertexSize);
+    free(timestamps);
+    free(referenced);
+}
+
+// Next vertex with live triangles: the last one added to the dead-end stack, then the
+// lowest numbered, for meshes in several disconnected pieces.
+static int SkipDeadEnd(const int* live, const unsigned int* deadEnd, int* deadEndCount, int* cursor, int vertexCount)
+{
+    while (*deadEndCount > 0)
+    {
+        unsigned int vertex = deadEnd[--*deadEndCount];
+        if (live[vertex] > 0)
+        {
+            return (int)vertex;
+        }
+    }
+    for (; *cursor < vertexCount; ++*cursor)
+    {
+        if (live[*cursor] > 0)
+        {
+            return *cursor;
+        }
+    }
+    return -1;
+}
+
+void MeshOpt_OptimizeCache(unsigned int* destination, const unsigned int* indices, int indexCount, int vertexCount,
+                           int cacheSize)
+{
+    int triangleCount = indexCount / 3;
+    if (triangleCount == 0)
+    {
+        return;
+    }
+
+    // Triangles around each vertex, and how many of them are still to be emitted.
+    int* live = calloc(vertexCount, sizeof(int));
+    int* offsets = calloc(vertexCount + 1, sizeof(int));
+    int* adjacency = malloc(triangleCount * 3 * sizeof(int));
+    unsigned int* timestamps = calloc(vertexCount, sizeof(unsigned int));
+    unsigned char* emitted = calloc(triangleCount, 1);
+    unsigned int* deadEnd = malloc(triangleCount * 3 * sizeof(unsigned int));
+    unsigned int* candidates = malloc(triangleCount * 3 * sizeof(unsigned int));
+    unsigned int* result = malloc(triangleCount * 3 * sizeof(unsigned int));
+    assert(live && offsets && adjacency && timestamps && emitted && deadEnd && candidates && result);
+
+    for (int i = 0; i < triangleCount * 3; ++i)
+    {
+        assert(indices[i] < (unsigned int)vertexCount);
+        ++live[indices[i]];
+    }
+    for (int v = 0; v < vertexCount; ++v)
+    {
+        offsets[v + 1] = offsets[v] + live[v];
+    }
+    int* fill = malloc(vertexCount * sizeof(int));
+    assert(fill);
+    memcpy(fill, offsets, vertexCount * sizeof(int));
+    for (int i = 0; i < triangleCount * 3; ++i)
+    {
+        adjacency[fill[indices[i]]++] = i / 3;
+    }
+    free(fill);
+
+    unsigned int time = (unsigned int)cacheSize + 1;
+    int resultCount = 0;
+    int deadEndCount = 0;
+    int cursor = 0;
+    int fan = SkipDeadEnd(live, deadEnd, &deadEndCount, &cursor, vertexCount);
+    while (fan >= 0)
+    {
+        int candidateCount = 0;
+        for (int a = offsets[fan]; a < offsets[fan + 1]; ++a)
+        {
+            int triangle = adjacency[a];
+            if (emitted[triangle])
+            {
+                continue;
+            }
+            emitted[triangle] = 1;
+            for (int k = 0; k < 3; ++k)
+            {
+                unsigned int vertex = indices[triangle * 3 + k];
+                result[resultCount++] = vertex;
+                deadEnd[deadEndCount++] = vertex;
+                candidates[candidateCount++] = vertex;
+                --live[vertex];
+                Touch(timestamps, vertex, &time, cacheSize);
+            }
+        }
+
+        // Prefer the oldest vertex that will still be cached once its own remaining
+        // triangles are emitted; otherwise any vertex of the fan with triangles left.
+        fan = -1;
+        int bestPriority = -1;
+        for (int c = 0; c < candidateCount; ++c)
+        {
+            unsigned int vertex = candidates[c];
+            if (live[vertex] <= 0)
+            {
+                continue;
+            }
+            int age = (int)(time - timestamps[vertex]);
+            int priority = age + 2 * live[vertex] <= cacheSize ? age : 0;
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                fan = (int)vertex;
+            }
+        }
+        if (fan < 0)
+        {
+            fan = SkipDeadEnd(live, deadEnd, &deadEndCount, &cursor, vertexCount);
+        }
+    }
+    assert(resultCount == triangleCount * 3);
+    memcpy(destination, result, resultCount * sizeof(unsigned int));
+
+    free(live);
+    free(offsets);
+    free(adjacency);
+    free(timestamps);
+    free(emitted);
+    free(deadEnd);
+    free(candidates);
+    free(result);
+}
+
+static void Position(const void* vertices, int vertexSize, unsigned int vertex, float* position)
+{
+    memcpy(position, (const char*)vertices + (size_t)vertex * vertexSize, 3 * sizeof(float));
+}
+
+typedef struct
+{
+    float key;
+    int cluster;
+} ClusterOrder;
+
+static int CompareClusters(const void* a, const void* b)
+{
+    const ClusterOrder* left = a;
+    const ClusterOrder* right = b;
+    if (left->key != right->key)
+    {
+        return left->key > right->key ? -1 : 1;
+    }
+    return left->cluster - right->cluster;
+}
+
+int MeshOpt_OptimizeOverdraw(unsigned int* indices, int indexCount, const void* vertices, int vertexCount,
+                             int vertexSize, int cacheSize, float threshold)
+{
+    int triangleCount = indexCount / 3;
+    if (triangleCount == 0)
+    {
+        return 0;
+    }
+
+    unsigned int* timestamps = calloc(vertexCount, sizeof(unsigned int));
+    int* hardStarts = malloc((triangleCount + 1) * sizeof(int));
+    int* starts = malloc((triangleCount + 1) * sizeof(int));
+    assert(timestamps && hardStarts && starts);
+
+    // A triangle that misses on all three vertices starts a new patch of the mesh;
+    // reordering whole patches costs no cache efficiency.
+    unsigned int time = (unsigned int)cacheSize + 1;
+    int hardCount = 0;
+    for (int t = 0; t < triangleCount; ++t)
+    {
+        int misses = 0;
+        for (int k = 0; k < 3; ++k)
+        {
+            misses += Touch(timestamps, indices[t * 3 + k], &time, cacheSize);
+        }
+        if (t == 0 || misses == 3)
+        {
+            hardStarts[hardCount++] = t;
+        }
+    }
+    hardStarts[hardCount] = triangleCount;
+
+    // Cut patches further wherever the cluster so far is within threshold of the
+    // patch's own ACMR, each cluster starting with an empty cache.
+    int clusterCount = 0;
+    for (int h = 0; h < hardCount; ++h)
+    {
+        int start = hardStarts[h];
+        int end = hardStarts[h + 1];
+        int patchMisses = 0;
+        time += (unsigned int)cacheSize + 1;
+        for (int i = start * 3; i < end * 3; ++i)
+        {
+            patchMisses += Touch(timestamps, indices[i], &time, cacheSize);
+        }
+        float target = (float)patchMisses / (end - start) * threshold;
+
+        starts[clusterCount++] = start;
+        time += (unsigned int)cacheSize + 1;
+        int misses = 0;
+        int faces = 0;
+        for (int t = start; t < end; ++t)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                misses += Touch(timestamps, indices[t * 3 + k], &time, cacheSize);
+            }
+            ++faces;
+            if (t + 1 < end && misses <= target * faces)
+            {
+                starts[clusterCount++] = t + 1;
+                time += (unsigned int)cacheSize + 1;
+                misses = 0;
+                faces = 0;
+            }
+        }
+    }
+    starts[clusterCount] = triangleCount;
+
+    // Area-weighted centroid and normal of each cluster and of the whole mesh.
+    float* centroids = calloc(clusterCount * 4, sizeof(float));
+    float* normals = calloc(clusterCount * 3, sizeof(float));
+    assert(centroids && normals);
+    float meshCentroid[4] = {0};
+    for (int c = 0; c < clusterCount; ++c)
+    {
+        float* centroid = centroids + c * 4;
+        float* normal = normals + c * 3;
+        for (int t = starts[c]; t < starts[c + 1]; ++t)
+        {
+            float p0[3], p1[3], p2[3];
+            Position(vertices, vertexSize, indices[t * 3 + 0], p0);
+            Position(vertices, vertexSize, indices[t * 3 + 1], p1);
+            Position(vertices, vertexSize, indices[t * 3 + 2], p2);
+            float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+            float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+            float n[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+            float area = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            for (int k = 0; k < 3; ++k)
+            {
+                centroid[k] += (p0[k] + p1[k] + p2[k]) / 3.0f * area;
+                normal[k] += n[k];
+            }
+            centroid[3] += area;
+        }
+        for (int k = 0; k < 4; ++k)
+        {
+            meshCentroid[k] += centroid[k];
+        }
+    }
+
+    // Clusters further out along their own facing direction draw first.
+    ClusterOrder* order = malloc(clusterCount * sizeof(ClusterOrder));
+    assert(order);
+    for (int c = 0; c < clusterCount; ++c)
+    {
+        const float* centroid = centroids + c * 4;
+        const float* normal = normals + c * 3;
+        float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        order[c].cluster = c;
+        order[c].key = 0.0f;
+        if (centroid[3] > 0.0f && meshCentroid[3] > 0.0f && length > 0.0f)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                order[c].key += (centroid[k] / centroid[3] - meshCentroid[k] / meshCentroid[3]) * normal[k] / length;
+            }
+        }
+    }
+    qsort(order, clusterCount, sizeof(ClusterOrder), CompareClusters);
+
+    unsigned int* result = malloc(triangleCount * 3 * sizeof(unsigned int));
+    assert(result);
+    int resultCount = 0;
+    for (int c = 0; c < clusterCount; ++c)
+    {
+        int cluster = order[c].cluster;
+        int count = (starts[cluster + 1] - starts[cluster]) * 3;
+        memcpy(result + resultCount, indices + starts[cluster] * 3, count * sizeof(unsigned int));
+        resultCount += count;
+    }
+    memcpy(indices, result, resultCount * sizeof(unsigned int));
+
+    free(timestamps);
+    free(hardStarts);
+    free(starts);
+    free(centroids);
+    free(normals);
+    free(order);
+    free(result);
+    return clusterCount;
+}
+
+int MeshOpt_FetchRemap(unsigned int* remap, const unsigned int* indices, int indexCount, int vertexCount)
+{
+    memset(remap, 0xFF, vertexCount * sizeof(unsigned int));
+    unsigned int next = 0;
+    for (int i = 0; i < indexCount; ++i)
+    {
+        assert(indices[i] < (unsigned int)vertexCount);
+        if (remap[indices[i]] == ~0u)
+        {
+            remap[indices[i]] = next++;
+        }
+    }
+    return (int)next;
+}
+
+// destination must not overlap vertices.
+void MeshOpt_RemapVertices(void* destination, const void* vertices, int vertexCount, int vertexSize,
+                           const unsigned int* remap)
+{
+    for (int v = 0; v < vertexCount; ++v)
+    {
+        if (remap[v] != ~0u)
+        {
+            memcpy((char*)destination + (size_t)remap[v] * vertexSize, (const char*)vertices + (size_t)v * vertexSize,
+                   vertexSize);
+        }
+    }
+}
+
+void MeshOpt_RemapIndices(unsigned int* destination, const unsigned int* indices, int indexCount,
+                          const unsigned int* remap)
+{
+    for (int i = 0; i < indexCount; ++i)
+    {
+        destination[i] = remap[indices[i]];
+    }
+}
+
+int MeshOpt_Optimize(void* vertices, int vertexCount, int vertexSize, unsigned int* indices, int indexCount,
+                     MeshOptStats* stats)
+{
+    if (stats)
+    {
+        MeshOpt_CacheStats(indices, indexCount, vertexCount, vertexSize, MESHOPT_CACHE_SIZE, &stats->before);
+    }
+
+    MeshOpt_OptimizeCache(indices, indices, indexCount, vertexCount, MESHOPT_CACHE_SIZE);
+    int clusterCount = MeshOpt_OptimizeOverdraw(indices, indexCount, vertices, vertexCount, vertexSize,
+                                                MESHOPT_CACHE_SIZE, MESHOPT_OVERDRAW_THRESHOLD);
+
+    unsigned int* remap = malloc(vertexCount * sizeof(unsigned int));
+    assert(remap);
+    int usedCount = MeshOpt_FetchRemap(remap, indices, indexCount, vertexCount);
+    MeshOpt_RemapIndices(indices, indices, indexCount, remap);
+    void* reordered = malloc((size_t)usedCount * vertexSize);
+    assert(reordered || usedCount == 0);
+    MeshOpt_RemapVertices(reordered, vertices, vertexCount, vertexSize, remap);
+    memcpy(vertices, reordered, (size_t)usedCount * vertexSize);
+    free(reordered);
+    free(remap);
+
+    if (stats)
+    {
+        MeshOpt_CacheStats(indices, indexCount, usedCount, vertexSize, MESHOPT_CACHE_SIZE, &stats->after);
+        stats->clusterCount = clusterCount;
+    }
+    return usedCount;
+}
+
+void MeshOpt_Report(const char* name, const MeshOptStats* stats)
+{
+    printf("Mesh %s: %d triangles in %d clusters, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f, overfetch %.2f -> %.2f\n",
+           name, stats->before.triangleCount, stats->clusterCount, stats->before.acmr, stats->after.acmr,
+           stats->before.atvr, stats->after.atvr, stats->before.overfetch, stats->after.overfetch);
+}
@@ -0,0 +1,735 @@
+#include "utils/meshpool.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+static int HighestBit(unsigned int value)
+{
+    return 31 - __builtin_clz(value);
+}
+
+static int LowestBit(unsigned int value)
+{
+    return __builtin_ctz(value);
+}
+
+// Size class of a free block: sizes below MESHPOOL_SL_COUNT get a class each, larger
+// ones share a power of two split into MESHPOOL_SL_COUNT steps.
+static void Mapping(unsigned int size, int* fl, int* sl)
+{
+    if (size < MESHPOOL_SL_COUNT)
+    {
+        *fl = 0;
+        *sl = (int)size;
+    }
+    else
+    {
+        int bit = HighestBit(size);
+        *fl = bit - MESHPOOL_SL_LOG2 + 1;
+        *sl = (int)((size >> (bit - MESHPOOL_SL_LOG2)) ^ MESHPOOL_SL_COUNT);
+    }
+}
+
+// Rounds up to the next class boundary, so any block found there is large enough.
+static void MappingSearch(unsigned int size, int* fl, int* sl)
+{
+    if (size >= MESHPOOL_SL_COUNT)
+    {
+        size += (1u << (HighestBit(size) - MESHPOOL_SL_LOG2)) - 1;
+    }
+    Mapping(size, fl, sl);
+}
+
+static int NewBlock(MeshArena* arena)
+{
+    if (arena->spareBlock >= 0)
+    {
+        int result = arena->spareBlock;
+        arena->spareBlock = arena->blocks[result].nextFree;
+        return result;
+    }
+    if (arena->blockCount == arena->blockCapacity)
+    {
+        arena->blockCapacity = arena->blockCapacity ? arena->blockCapacity * 2 : 64;
+        arena->blocks = realloc(arena->blocks, arena->blockCapacity * sizeof(MeshBlock));
+        assert(arena->blocks);
+    }
+    return arena->blockCount++;
+}
+
+static void ReleaseBlock(MeshArena* arena, int index)
+{
+    MeshBlock* block = arena->blocks + index;
+    memset(block, 0, sizeof(*block));
+    block->nextFree = arena->spareBlock;
+    arena->spareBlock = index;
+}
+
+static void InsertFree(MeshArena* arena, int index)
+{
+    MeshBlock* block = arena->blocks + index;
+    int fl, sl;
+    Mapping((unsigned int)block->size, &fl, &sl);
+
+    block->isFree = 1;
+    block->prevFree = -1;
+    block->nextFree = arena->heads[fl][sl];
+    if (block->nextFree >= 0)
+    {
+        arena->blocks[block->nextFree].prevFree = index;
+    }
+    arena->heads[fl][sl] = index;
+    arena->firstLevel |= 1u << fl;
+    arena->secondLevel[fl] |= 1u << sl;
+}
+
+static void RemoveFree(MeshArena* arena, int index)
+{
+    MeshBlock* block = arena->blocks + index;
+    int fl, sl;
+    Mapping((unsigned int)block->size, &fl, &sl);
+
+    if (block->prevFree >= 0)
+    {
+        arena->blocks[block->prevFree].nextFree = block->nextFree;
+    }
+    else
+    {
+        arena->heads[fl][sl] = block->nextFree;
+    }
+    if (block->nextFree >= 0)
+    {
+        arena->blocks[block->nextFree].prevFree = block->prevFree;
+    }
+    if (arena->heads[fl][sl] < 0)
+    {
+        arena->secondLevel[fl] &= ~(1u << sl);
+        if (!arena->secondLevel[fl])
+        {
+            arena->firstLevel &= ~(1u << fl);
+        }
+    }
+    block->isFree = 0;
+}
+
+static void ArenaInit(MeshArena* arena, int capacity)
+{
+    memset(arena, 0, sizeof(*arena));
+    memset(arena->heads, 0xFF, sizeof(arena->heads));
+    arena->capacity = capacity;
+    arena->spareBlock = -1;
+
+    int index = NewBlock(arena);
+    MeshBlock* block = arena->blocks + index;
+    block->offset = 0;
+    block->size = capacity;
+    block->prevPhysical = -1;
+    block->nextPhysical = -1;
+    InsertFree(arena, index);
+}
+
+static void ArenaFree(MeshArena* arena)
+{
+    free(arena->blocks);
+    memset(arena, 0, sizeof(*arena));
+}
+
+// Any block in a class above size's own fits, so the rounded search takes the first
+// one found. Blocks in size's own class may be smaller or larger than size; only when
+// nothing bigger is free are they checked one by one, so a request as large as the
+// largest free block still succeeds.
+static int FindFree(const MeshArena* arena, int size)
+{
+    int fl, sl;
+    MappingSearch((unsigned int)size, &fl, &sl);
+    if (fl < MESHPOOL_FL_COUNT)
+    {
+        unsigned int secondMap = arena->secondLevel[fl] & (~0u << sl);
+        if (!secondMap)
+        {
+            unsigned int firstMap = fl + 1 < MESHPOOL_FL_COUNT ? arena->firstLevel & (~0u << (fl + 1)) : 0;
+            if (firstMap)
+            {
+                fl = LowestBit(firstMap);
+                secondMap = arena->secondLevel[fl];
+            }
+        }
+        if (secondMap)
+        {
+            return arena->heads[fl][LowestBit(secondMap)];
+        }
+    }
+
+    Mapping((unsigned int)size, &fl, &sl);
+    for (int index = arena->heads[fl][sl]; index >= 0; index = arena->blocks[index].nextFree)
+    {
+        if (arena->blocks[index].size >= size)
+        {
+            return index;
+        }
+    }
+    return -1;
+}
+
+// Returns a block of exactly size elements, or -1 if no free block is large enough.
+static int ArenaAlloc(MeshArena* arena, int size)
+{
+    if (size <= 0 || size > arena->capacity)
+    {
+        return -1;
+    }
+
+    int index = FindFree(arena, size);
+    if (index < 0)
+    {
+        return -1;
+    }
+    RemoveFree(arena, index);
+
+    // The tail goes back as a free block of its own.
+    if (arena->blocks[index].size > size)
+    {
+        int rest = NewBlock(arena);
+        MeshBlock* block = arena->blocks + index;
+        MeshBlock* tail = arena->blocks + rest;
+        tail->offset = block->offset + size;
+        tail->size = block->size - size;
+        tail->prevPhysical = index;
+        tail->nextPhysical = block->nextPhysical;
+        if (tail->nextPhysical >= 0)
+        {
+            arena->blocks[tail->nextPhysical].prevPhysical = rest;
+        }
+        block->nextPhysical = rest;
+        block->size = size;
+        InsertFree(arena, rest);
+    }
+
+    arena->used += size;
+    return index;
+}
+
+// Merges the block with free neighbours, so free space never sits in adjacent pieces.
+static void ArenaRelease(MeshArena* arena, int index)
+{
+    arena->used -= arena->blocks[index].size;
+
+    int next = arena->blocks[index].nextPhysical;
+    if (next >= 0 && arena->blocks[next].isFree)
+    {
+        RemoveFree(arena, next);
+        arena->blocks[index].size += arena->blocks[next].size;
+        arena->blocks[index].nextPhysical = arena->blocks[next].nextPhysical;
+        if (arena->blocks[index].nextPhysical >= 0)
+        {
+            arena->blocks[arena->blocks[index].nextPhysical].prevPhysical = index;
+        }
+        ReleaseBlock(arena, next);
+    }
+
+    int prev = arena->blocks[index].prevPhysical;
+    if (prev >= 0 && arena->blocks[prev].isFree)
+    {
+        RemoveFree(arena, prev);
+        arena->blocks[prev].size += arena->blocks[index].size;
+        arena->blocks[prev].nextPhysical = arena->blocks[index].nextPhysical;
+        if (arena->blocks[prev].nextPhysical >= 0)
+        {
+            arena->blocks[arena->blocks[prev].nextPhysical].prevPhysical = prev;
+        }
+        ReleaseBlock(arena, index);
+        index = prev;
+    }
+
+    InsertFree(arena, index);
+}
+
+static void ArenaFreeSpace(const MeshArena* arena, int* freeBlockCount, int* largest)
+{
+    for (int i = 0; i < arena->blockCount; ++i)
+    {
+        const MeshBlock* block = arena->blocks + i;
+        if (block->isFree)
+        {
+            ++*freeBlockCount;
+            if (block->size > *largest)
+            {
+                *largest = block->size;
+            }
+        }
+    }
+}
+
+static size_t IndexSize(GLenum type)
+{
+    switch (type)
+    {
+        case GL_UNSIGNED_BYTE: return 1;
+        case GL_UNSIGNED_SHORT: return 2;
+        default: return 4;
+    }
+}
+
+static GLuint RestartValue(GLenum type)
+{
+    switch (type)
+    {
+        case GL_UNSIGNED_BYTE: return 0xFF;
+        case GL_UNSIGNED_SHORT: return 0xFFFF;
+        default: return 0xFFFFFFFFu;
+    }
+}
+
+// Rounded to 4 bytes, so every range in the index buffer is aligned for any type.
+static int IndexBytes(const MeshRange* mesh)
+{
+    return (int)(((size_t)mesh->indexCount * IndexSize(mesh->indexType) + 3) & ~(size_t)3);
+}
+
+// The largest value of each type is kept for restarts, so a mesh drawn with restart
+// enabled never mistakes a real index for one.
+static GLenum ChooseIndexType(const MeshPool* pool, const unsigned int* indices, int indexCount, int* primitiveRestart)
+{
+    unsigned int largest = 0;
+    *primitiveRestart = 0;
+    for (int i = 0; i < indexCount; ++i)
+    {
+        if (indices[i] == MESHPOOL_RESTART_INDEX)
+        {
+            *primitiveRestart = 1;
+        }
+        else if (indices[i] > largest)
+        {
+            largest = indices[i];
+        }
+    }
+
+    if (pool->allowByteIndices && largest < 0xFF)
+    {
+        return GL_UNSIGNED_BYTE;
+    }
+    return largest < 0xFFFF ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+// Indices narrowed to type, restarts included; NULL when they are already 32-bit.
+static void* PackIndices(const unsigned int* indices, int indexCount, GLenum type)
+{
+    if (type == GL_UNSIGNED_INT)
+    {
+        return NULL;
+    }
+
+    void* result = malloc((size_t)indexCount * IndexSize(type));
+    assert(result);
+    GLuint restart = RestartValue(type);
+    for (int i = 0; i < indexCount; ++i)
+    {
+        GLuint index = indices[i] == MESHPOOL_RESTART_INDEX ? restart : indices[i];
+        if (type == GL_UNSIGNED_BYTE)
+        {
+            ((unsigned char*)result)[i] = (unsigned char)index;
+        }
+        else
+        {
+            ((unsigned short*)result)[i] = (unsigned short)index;
+        }
+    }
+    return result;
+}
+
+// Leaves the new page's VAO bound. indexBytes is the least index memory it must hold.
+static int CreatePage(MeshPool* pool, int vertexCount, int indexBytes)
+{
+    if (pool->pageCount == MESHPOOL_MAX_PAGES)
+    {
+        return -1;
+    }
+
+    int index = pool->pageCount++;
+    MeshPage* page = pool->pages + index;
+    ArenaInit(&page->vertices, vertexCount > pool->pageVertexCount ? vertexCount : pool->pageVertexCount);
+    int pageIndexBytes = pool->pageIndexCount * (int)sizeof(unsigned int);
+    ArenaInit(&page->indices, indexBytes > pageIndexBytes ? indexBytes : pageIndexBytes);
+
+    glGenVertexArrays(1, &page->vao);
+    glGenBuffers(1, &page->vertexBuffer);
+    glGenBuffers(1, &page->indexBuffer);
+
+    glBindVertexArray(page->vao);
+    pool->boundPage = index;
+    ++pool->vaoBindCount;
+    glBindBuffer(GL_ARRAY_BUFFER, page->vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)page->vertices.capacity * pool->vertexSize, NULL, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, page->indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)page->indices.capacity, NULL, GL_STATIC_DRAW);
+    for (int i = 0; i < pool->attributeCount; ++i)
+    {
+        const MeshAttribute* attribute = pool->attributes + i;
+        glVertexAttribPointer(attribute->index, attribute->size, attribute->type, attribute->normalized,
+                              pool->vertexSize, (void*)(uintptr_t)attribute->offset);
+        glEnableVertexAttribArray(attribute->index);
+    }
+
+    return index;
+}
+
+static void DeletePage(MeshPage* page)
+{
+    glDeleteVertexArrays(1, &page->vao);
+    glDeleteBuffers(1, &page->vertexBuffer);
+    glDeleteBuffers(1, &page->indexBuffer);
+    ArenaFree(&page->vertices);
+    ArenaFree(&page->indices);
+    memset(page, 0, sizeof(*page));
+}
+
+static int Place(MeshPool* pool, int pageIndex, MeshRange* mesh)
+{
+    MeshPage* page = pool->pages + pageIndex;
+    int vertexBlock = ArenaAlloc(&page->vertices, mesh->vertexCount);
+    if (vertexBlock < 0)
+    {
+        return 0;
+    }
+    int indexBlock = ArenaAlloc(&page->indices, IndexBytes(mesh));
+    if (indexBlock < 0)
+    {
+        ArenaRelease(&page->vertices, vertexBlock);
+        return 0;
+    }
+
+    mesh->page = pageIndex;
+    mesh->vertexBlock = vertexBlock;
+    mesh->indexBlock = indexBlock;
+    mesh->baseVertex = page->vertices.blocks[vertexBlock].offset;
+    mesh->firstIndex = (GLuint)(page->indices.blocks[indexBlock].offset / IndexSize(mesh->indexType));
+    return 1;
+}
+
+// A page sized for at least this mesh; released again if the mesh still does not fit,
+// so failures do not use up MESHPOOL_MAX_PAGES.
+static int PlaceOnNewPage(MeshPool* pool, MeshRange* mesh)
+{
+    int page = CreatePage(pool, mesh->vertexCount, IndexBytes(mesh));
+    if (page < 0)
+    {
+        return 0;
+    }
+    if (!Place(pool, page, mesh))
+    {
+        DeletePage(pool->pages + page);
+        --pool->pageCount;
+        pool->boundPage = -1;
+        return 0;
+    }
+    return 1;
+}
+
+// First page with room for both ranges, or a new page.
+static int PlaceAnywhere(MeshPool* pool, MeshRange* mesh)
+{
+    for (int i = 0; i < pool->pageCount; ++i)
+    {
+        if (Place(pool, i, mesh))
+        {
+            return 1;
+        }
+    }
+    return PlaceOnNewPage(pool, mesh);
+}
+
+// attributes describe one vertex of vertexSize bytes; each page holds pageVertexCount
+// vertices and pageIndexCount 32-bit indices' worth of index memory, or one mesh if
+// it is larger.
+void MeshPool_Init(MeshPool* pool, GLsizei vertexSize, const MeshAttribute* attributes, int attributeCount,
+                   int pageVertexCount, int pageIndexCount)
+{
+    memset(pool, 0, sizeof(*pool));
+    assert(attributeCount <= MESHPOOL_MAX_ATTRIBUTES);
+    pool->vertexSize = vertexSize;
+    memcpy(pool->attributes, attributes, attributeCount * sizeof(MeshAttribute));
+    pool->attributeCount = attributeCount;
+    pool->pageVertexCount = pageVertexCount;
+    pool->pageIndexCount = pageIndexCount;
+    pool->spareMesh = -1;
+    pool->boundPage = -1;
+    glDisable(GL_PRIMITIVE_RESTART);
+}
+
+void MeshPool_Free(MeshPool* pool)
+{
+    for (int i = 0; i < pool->pageCount; ++i)
+    {
+        DeletePage(pool->pages + i);
+    }
+    free(pool->meshes);
+    memset(pool, 0, sizeof(*pool));
+}
+
+// Copies the triangle list into the pool; returns a handle, or -1 once
+// MESHPOOL_MAX_PAGES are full.
+int MeshPool_Add(MeshPool* pool, const void* vertices, int vertexCount, const unsigned int* indices, int indexCount)
+{
+    return MeshPool_AddPrimitives(pool, GL_TRIANGLES, vertices, vertexCount, indices, indexCount);
+}
+
+// Any primitive mode; strips and fans may separate primitives with MESHPOOL_RESTART_INDEX.
+int MeshPool_AddPrimitives(MeshPool* pool, GLenum mode, const void* vertices, int vertexCount,
+                           const unsigned int* indices, int indexCount)
+{
+    if (vertexCount <= 0 || indexCount <= 0)
+    {
+        return -1;
+    }
+
+    MeshRange mesh = {0};
+    mesh.mode = mode;
+    mesh.vertexCount = vertexCount;
+    mesh.indexCount = indexCount;
+    mesh.indexType = ChooseIndexType(pool, indices, indexCount, &mesh.primitiveRestart);
+    if (!PlaceAnywhere(pool, &mesh))
+    {
+        return -1;
+    }
+
+    // Uploads go through the copy target, so no VAO's element buffer binding changes.
+    const MeshPage* page = pool->pages + mesh.page;
+    glBindBuffer(GL_COPY_WRITE_BUFFER, page->vertexBuffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)mesh.baseVertex * pool->vertexSize,
+                    (GLsizeiptr)vertexCount * pool->vertexSize, vertices);
+    void* packed = PackIndices(indices, indexCount, mesh.indexType);
+    size_t indexSize = IndexSize(mesh.indexType);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, page->indexBuffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)(mesh.firstIndex * indexSize),
+                    (GLsizeiptr)(indexCount * indexSize), packed ? packed : (const void*)indices);
+    free(packed);
+
+    int handle;
+    if (pool->spareMesh >= 0)
+    {
+        handle = pool->spareMesh;
+        pool->spareMesh = pool->meshes[handle].vertexBlock;
+    }
+    else
+    {
+        if (pool->meshCount == pool->meshCapacity)
+        {
+            pool->meshCapacity = pool->meshCapacity ? pool->meshCapacity * 2 : 64;
+            pool->meshes = realloc(pool->meshes, pool->meshCapacity * sizeof(MeshRange));
+            assert(pool->meshes);
+        }
+        handle = pool->meshCount++;
+    }
+    pool->meshes[handle] = mesh;
+    return handle;
+}
+
+// The handle may be returned by a later MeshPool_Add.
+void MeshPool_Remove(MeshPool* pool, int handle)
+{
+    MeshRange* mesh = pool->meshes + handle;
+    MeshPage* page = pool->pages + mesh->page;
+    ArenaRelease(&page->vertices, mesh->vertexBlock);
+    ArenaRelease(&page->indices, mesh->indexBlock);
+
+    memset(mesh, 0, sizeof(*mesh));
+    mesh->page = -1;
+    mesh->vertexBlock = pool->spareMesh;
+    pool->spareMesh = handle;
+}
+
+// Valid until the next MeshPool_Defragment.
+const MeshRange* MeshPool_Mesh(const MeshPool* pool, int handle)
+{
+    return pool->meshes + handle;
+}
+
+// Binds the mesh's page only if the last pool draw used another one, and switches
+// primitive restart to what the mesh needs. Binding a VAO or changing restart state
+// outside the pool between draws needs pool->boundPage reset to -1.
+static void BindMesh(MeshPool* pool, const MeshRange* mesh)
+{
+    if (mesh->page != pool->boundPage)
+    {
+        glBindVertexArray(pool->pages[mesh->page].vao);
+        pool->boundPage = mesh->page;
+        ++pool->vaoBindCount;
+    }
+    if (mesh->primitiveRestart != pool->restartEnabled)
+    {
+        if (mesh->primitiveRestart)
+        {
+            glEnable(GL_PRIMITIVE_RESTART);
+        }
+        else
+        {
+            glDisable(GL_PRIMITIVE_RESTART);
+        }
+        pool->restartEnabled = mesh->primitiveRestart;
+    }
+    if (mesh->primitiveRestart && pool->restartIndex != RestartValue(mesh->indexType))
+    {
+        pool->restartIndex = RestartValue(mesh->indexType);
+        glPrimitiveRestartIndex(pool->restartIndex);
+    }
+}
+
+void MeshPool_Draw(MeshPool* pool, int handle)
+{
+    const MeshRange* mesh = pool->meshes + handle;
+    BindMesh(pool, mesh);
+    glDrawElementsBaseVertex(mesh->mode, mesh->indexCount, mesh->indexType,
+                             (void*)((uintptr_t)mesh->firstIndex * IndexSize(mesh->indexType)), mesh->baseVertex);
+    ++pool->drawCount;
+}
+
+// Draws instanceCount copies; per-instance attributes come from an InstanceBuffer
+// attached to the pool (utils/instances.h).
+void MeshPool_DrawInstanced(MeshPool* pool, int handle, GLsizei instanceCount)
+{
+    const MeshRange* mesh = pool->meshes + handle;
+    BindMesh(pool, mesh);
+    glDrawElementsInstancedBaseVertex(mesh->mode, mesh->indexCount, mesh->indexType,
+                                      (void*)((uintptr_t)mesh->firstIndex * IndexSize(mesh->indexType)),
+                                      instanceCount, mesh->baseVertex);
+    ++pool->drawCount;
+}
+
+static const MeshPool* sortPool;
+
+static int CompareByPlacement(const void* a, const void* b)
+{
+    const MeshRange* left = sortPool->meshes + *(const int*)a;
+    const MeshRange* right = sortPool->meshes + *(const int*)b;
+    if (left->page != right->page)
+    {
+        return left->page - right->page;
+    }
+    return left->baseVertex - right->baseVertex;
+}
+
+// Repacks every mesh front to back into fresh pages with glCopyBufferSubData, so
+// free space ends up in one piece per page and emptied pages are released. Handles
+// stay valid; ranges move, and pages are new VAOs, so attach instance buffers again.
+// Needs room for the old and new pages at once. Returns 0, with nothing moved, if
+// the meshes no longer fit in MESHPOOL_MAX_PAGES.
+int MeshPool_Defragment(MeshPool* pool)
+{
+    int liveCount = 0;
+    int* order = malloc((pool->meshCount + 1) * sizeof(int));
+    assert(order);
+    for (int i = 0; i < pool->meshCount; ++i)
+    {
+        if (pool->meshes[i].page >= 0)
+        {
+            order[liveCount++] = i;
+        }
+    }
+    sortPool = pool;
+    qsort(order, liveCount, sizeof(int), CompareByPlacement);
+
+    MeshPage oldPages[MESHPOOL_MAX_PAGES];
+    int oldPageCount = pool->pageCount;
+    memcpy(oldPages, pool->pages, sizeof(oldPages));
+    MeshRange* oldMeshes = malloc((pool->meshCount + 1) * sizeof(MeshRange));
+    assert(oldMeshes);
+    memcpy(oldMeshes, pool->meshes, pool->meshCount * sizeof(MeshRange));
+    memset(pool->pages, 0, sizeof(pool->pages));
+    pool->pageCount = 0;
+
+    int success = 1;
+    for (int i = 0; i < liveCount && success; ++i)
+    {
+        // Filling the last new page in order packs meshes without gaps.
+        MeshRange* mesh = pool->meshes + order[i];
+        const MeshRange* old = oldMeshes + order[i];
+        success = pool->pageCount > 0 && Place(pool, pool->pageCount - 1, mesh);
+        if (!success)
+        {
+            success = PlaceOnNewPage(pool, mesh);
+        }
+        if (!success)
+        {
+            break;
+        }
+
+        const MeshPage* from = oldPages + old->page;
+        const MeshPage* to = pool->pages + mesh->page;
+        glBindBuffer(GL_COPY_READ_BUFFER, from->vertexBuffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, to->vertexBuffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, (GLintptr)old->baseVertex * pool->vertexSize,
+                            (GLintptr)mesh->baseVertex * pool->vertexSize, (GLsizeiptr)mesh->vertexCount * pool->vertexSize);
+        glBindBuffer(GL_COPY_READ_BUFFER, from->indexBuffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, to->indexBuffer);
+        size_t indexSize = IndexSize(mesh->indexType);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, (GLintptr)(old->firstIndex * indexSize),
+                            (GLintptr)(mesh->firstIndex * indexSize), (GLsizeiptr)(mesh->indexCount * indexSize));
+    }
+
+    MeshPage* discard = success ? oldPages : pool->pages;
+    int discardCount = success ? oldPageCount : pool->pageCount;
+    for (int i = 0; i < discardCount; ++i)
+    {
+        DeletePage(discard + i);
+    }
+    if (!success)
+    {
+        memcpy(pool->pages, oldPages, sizeof(oldPages));
+        pool->pageCount = oldPageCount;
+        memcpy(pool->meshes, oldMeshes, pool->meshCount * sizeof(MeshRange));
+    }
+    pool->boundPage = -1;
+
+    free(oldMeshes);
+    free(order);
+    return success;
+}
+
+void MeshPool_Stats(const MeshPool* pool, MeshPoolStats* stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    stats->pageCount = pool->pageCount;
+    for (int i = 0; i < pool->meshCount; ++i)
+    {
+        const MeshRange* mesh = pool->meshes + i;
+        if (mesh->page >= 0)
+        {
+            ++stats->meshCount;
+            stats->savedIndexBytes += (size_t)mesh->indexCount * (sizeof(unsigned int) - IndexSize(mesh->indexType));
+        }
+    }
+
+    size_t freeSpace = 0;
+    size_t largestSpace = 0;
+    for (int i = 0; i < pool->pageCount; ++i)
+    {
+        const MeshPage* page = pool->pages + i;
+        stats->vertexBytes += (size_t)page->vertices.capacity * pool->vertexSize;
+        stats->usedVertexBytes += (size_t)page->vertices.used * pool->vertexSize;
+        stats->indexBytes += (size_t)page->indices.capacity;
+        stats->usedIndexBytes += (size_t)page->indices.used;
+
+        int largestVertices = 0;
+        int largestIndices = 0;
+        ArenaFreeSpace(&page->vertices, &stats->freeBlockCount, &largestVertices);
+        ArenaFreeSpace(&page->indices, &stats->freeBlockCount, &largestIndices);
+        freeSpace += (size_t)(page->vertices.capacity - page->vertices.used) * pool->vertexSize +
+                     (size_t)(page->indices.capacity - page->indices.used);
+        largestSpace += (size_t)largestVertices * pool->vertexSize + (size_t)largestIndices;
+    }
+    stats->fragmentation = freeSpace ? 1.0f - (float)largestSpace / (float)freeSpace : 0.0f;
+}
+
+void MeshPool_Report(const MeshPool* pool)
+{
+    MeshPoolStats stats;
+    MeshPool_Stats(pool, &stats);
+    printf("Mesh pool: %d meshes in %d pages, vertices %.1f of %.1f KB, indices %.1f of %.1f KB "
+           "(%.1f KB saved by narrow types), %d free blocks, %.0f%% fragmented, %d draws, %d VAO binds\n",
+           stats.meshCount, stats.pageCount, stats.usedVertexBytes / 1024.0, stats.vertexBytes / 1024.0,
+           stats.usedIndexBytes / 1024.0, stats.indexBytes / 1024.0, stats.savedIndexBytes / 1024.0, stats.freeBlockCount,
+           stats.fragmentation * 100.0f, pool->drawCount, pool->vaoBindCount);
+}
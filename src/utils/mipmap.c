@@ -0,0 +1,296 @@
+#include "utils/mipmap.h"
+#include "utils/simd.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define KAISER_WIDTH 3.0f
+#define KAISER_ALPHA 4.0f
+#define LINEAR_TO_SRGB_SIZE 16384
+
+static float srgbToLinear[256];
+static unsigned char linearToSrgb[LINEAR_TO_SRGB_SIZE];
+static pthread_once_t tablesOnce = PTHREAD_ONCE_INIT;
+
+static void InitTables(void)
+{
+    for (int i = 0; i < 256; ++i)
+    {
+        float s = i / 255.0f;
+        srgbToLinear[i] = s <= 0.04045f ? s / 12.92f : powf((s + 0.055f) / 1.055f, 2.4f);
+    }
+    for (int i = 0; i < LINEAR_TO_SRGB_SIZE; ++i)
+    {
+        float l = (float)i / (LINEAR_TO_SRGB_SIZE - 1);
+        float s = l <= 0.0031308f ? l * 12.92f : 1.055f * powf(l, 1.0f / 2.4f) - 0.055f;
+        linearToSrgb[i] = (unsigned char)(s * 255.0f + 0.5f);
+    }
+}
+
+typedef struct
+{
+    int first;
+    int count;
+} FilterSpan;
+
+// Per destination pixel: the source range it reads and the normalized weights.
+typedef struct
+{
+    FilterSpan* spans;
+    float* weights;
+    int stride;
+} Filter;
+
+static float Bessel0(float x)
+{
+    float sum = 1.0f;
+    float term = 1.0f;
+    float halfX = 0.5f * x;
+    for (int k = 1; k < 32 && term > 1e-8f * sum; ++k)
+    {
+        term *= (halfX / k) * (halfX / k);
+        sum += term;
+    }
+    return sum;
+}
+
+static float KaiserWeight(float t)
+{
+    if (fabsf(t) >= KAISER_WIDTH)
+    {
+        return 0.0f;
+    }
+
+    float ratio = t / KAISER_WIDTH;
+    float window = Bessel0(KAISER_ALPHA * sqrtf(1.0f - ratio * ratio)) / Bessel0(KAISER_ALPHA);
+    float sinc = t == 0.0f ? 1.0f : sinf((float)M_PI * t) / ((float)M_PI * t);
+    return sinc * window;
+}
+
+static void Filter_Build(Filter* filter, int srcSize, int dstSize, MipFilter type)
+{
+    // An axis that is not being reduced any more is copied through unfiltered.
+    if (srcSize == dstSize)
+    {
+        type = MipFilter_Box;
+    }
+
+    float scale = (float)srcSize / dstSize;
+    float support = type == MipFilter_Box ? 0.5f * scale : KAISER_WIDTH * scale;
+    filter->stride = (int)ceilf(2.0f * support) + 2;
+    filter->spans = malloc(dstSize * sizeof(FilterSpan));
+    filter->weights = malloc(dstSize * filter->stride * sizeof(float));
+    assert(filter->spans && filter->weights);
+
+    for (int i = 0; i < dstSize; ++i)
+    {
+        float center = (i + 0.5f) * scale;
+        int first = (int)floorf(center - support);
+        int last = (int)ceilf(center + support) - 1;
+        float* weights = filter->weights + i * filter->stride;
+        float sum = 0.0f;
+        int count = 0;
+
+        for (int s = first; s <= last && count < filter->stride; ++s)
+        {
+            float w;
+            if (type == MipFilter_Box)
+            {
+                float lo = fmaxf((float)s, center - support);
+                float hi = fminf((float)(s + 1), center + support);
+                w = fmaxf(0.0f, hi - lo);
+            }
+            else
+            {
+                w = KaiserWeight((s + 0.5f - center) / scale);
+            }
+            weights[count++] = w;
+            sum += w;
+        }
+
+        for (int k = 0; k < count; ++k)
+        {
+            weights[k] /= sum;
+        }
+        filter->spans[i].first = first;
+        filter->spans[i].count = count;
+    }
+}
+
+static void Filter_Free(Filter* filter)
+{
+    free(filter->spans);
+    free(filter->weights);
+}
+
+static inline int ClampIndex(int i, int size)
+{
+    return i < 0 ? 0 : (i >= size ? size - 1 : i);
+}
+
+static inline int IsAlphaChannel(int channel, int channelCount)
+{
+    return (channelCount == 2 && channel == 1) || (channelCount == 4 && channel == 3);
+}
+
+// Pixels are filtered as four float lanes (one per channel) so the same
+// code path handles grey, grey-alpha, RGB and RGBA images.
+static void DecodeRow(const unsigned char* src, int width, int channelCount, int srgb, float* dst)
+{
+    for (int x = 0; x < width; ++x)
+    {
+        for (int c = 0; c < 4; ++c)
+        {
+            float value = 0.0f;
+            if (c < channelCount)
+            {
+                unsigned char byte = src[x * channelCount + c];
+                value = (srgb && !IsAlphaChannel(c, channelCount)) ? srgbToLinear[byte] : byte / 255.0f;
+            }
+            dst[x * 4 + c] = value;
+        }
+    }
+}
+
+static void EncodeRow(const float* src, int width, int channelCount, int srgb, unsigned char* dst)
+{
+    float lanes[4];
+    for (int x = 0; x < width; ++x)
+    {
+        Vec4_Store(lanes, Vec4_Clamp01(Vec4_Load(src + x * 4)));
+        for (int c = 0; c < channelCount; ++c)
+        {
+            if (srgb && !IsAlphaChannel(c, channelCount))
+            {
+                dst[x * channelCount + c] = linearToSrgb[(int)(lanes[c] * (LINEAR_TO_SRGB_SIZE - 1) + 0.5f)];
+            }
+            else
+            {
+                dst[x * channelCount + c] = (unsigned char)(lanes[c] * 255.0f + 0.5f);
+            }
+        }
+    }
+}
+
+int Mip_LevelCount(int width, int height)
+{
+    int result = 1;
+    while (width > 1 || height > 1)
+    {
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+        ++result;
+    }
+    return result;
+}
+
+void Mip_Downsample(const unsigned char* src, int srcWidth, int srcHeight,
+                    unsigned char* dst, int dstWidth, int dstHeight,
+                    int channelCount, int srgb, MipFilter filter)
+{
+    pthread_once(&tablesOnce, InitTables);
+
+    Filter horizontal, vertical;
+    Filter_Build(&horizontal, srcWidth, dstWidth, filter);
+    Filter_Build(&vertical, srcHeight, dstHeight, filter);
+
+    float* srcRow = malloc(srcWidth * 4 * sizeof(float));
+    float* columns = malloc((size_t)dstWidth * srcHeight * 4 * sizeof(float));
+    float* dstRow = malloc(dstWidth * 4 * sizeof(float));
+    assert(srcRow && columns && dstRow);
+
+    // Horizontal pass: every source row shrinks to dstWidth linear pixels.
+    for (int y = 0; y < srcHeight; ++y)
+    {
+        DecodeRow(src + (size_t)y * srcWidth * channelCount, srcWidth, channelCount, srgb, srcRow);
+        float* out = columns + (size_t)y * dstWidth * 4;
+        for (int x = 0; x < dstWidth; ++x)
+        {
+            FilterSpan span = horizontal.spans[x];
+            const float* weights = horizontal.weights + x * horizontal.stride;
+            Vec4 acc = Vec4_Zero();
+            for (int k = 0; k < span.count; ++k)
+            {
+                int s = ClampIndex(span.first + k, srcWidth);
+                acc = Vec4_MulAdd(acc, Vec4_Splat(weights[k]), Vec4_Load(srcRow + s * 4));
+            }
+            Vec4_Store(out + x * 4, acc);
+        }
+    }
+
+    // Vertical pass: whole rows are accumulated at once.
+    for (int y = 0; y < dstHeight; ++y)
+    {
+        FilterSpan span = vertical.spans[y];
+        const float* weights = vertical.weights + y * vertical.stride;
+        memset(dstRow, 0, dstWidth * 4 * sizeof(float));
+        for (int k = 0; k < span.count; ++k)
+        {
+            const float* row = columns + (size_t)ClampIndex(span.first + k, srcHeight) * dstWidth * 4;
+            Vec4 w = Vec4_Splat(weights[k]);
+            for (int x = 0; x < dstWidth; ++x)
+            {
+                Vec4_Store(dstRow + x * 4, Vec4_MulAdd(Vec4_Load(dstRow + x * 4), w, Vec4_Load(row + x * 4)));
+            }
+        }
+        EncodeRow(dstRow, dstWidth, channelCount, srgb, dst + (size_t)y * dstWidth * channelCount);
+    }
+
+    free(dstRow);
+    free(columns);
+    free(srcRow);
+    Filter_Free(&vertical);
+    Filter_Free(&horizontal);
+}
+
+int Mip_GenerateChain(Image* image, MipFilter filter)
+{
+    int levelCount = Mip_LevelCount(image->width, image->height);
+    if (levelCount > IMAGE_MAX_LEVELS)
+    {
+        levelCount = IMAGE_MAX_LEVELS;
+    }
+
+    size_t dataSize = 0;
+    int w = image->width;
+    int h = image->height;
+    for (int i = 0; i < levelCount; ++i)
+    {
+        ImageLevel* level = image->levels + i;
+        level->width = w;
+        level->height = h;
+        level->offset = dataSize;
+        level->size = (size_t)w * h * image->channelCount;
+        dataSize += level->size;
+        w = w > 1 ? w / 2 : 1;
+        h = h > 1 ? h / 2 : 1;
+    }
+
+    unsigned char* data = realloc(image->data, dataSize);
+    if (!data)
+    {
+        return 0;
+    }
+    image->data = data;
+    image->dataSize = dataSize;
+    image->levelCount = levelCount;
+
+    int srgb = (image->flags & IMAGE_FLAG_SRGB) != 0;
+    for (int i = 1; i < levelCount; ++i)
+    {
+        const ImageLevel* src = image->levels + i - 1;
+        const ImageLevel* dst = image->levels + i;
+        Mip_Downsample(data + src->offset, src->width, src->height,
+                       data + dst->offset, dst->width, dst->height,
+                       image->channelCount, srgb, filter);
+    }
+
+    return 1;
+}
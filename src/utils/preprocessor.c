@@ -0,0 +1,405 @@
+#include "utils/preprocessor.h"
+#include "utils/hash.h"
+#include "utils/utils.h"
+#include "utils/shaderfiles.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+typedef struct
+{
+    char* data;
+    size_t size;
+    size_t capacity;
+} TextBuffer;
+
+static void Append(TextBuffer* buffer, const char* text, size_t size)
+{
+    if (buffer->size + size + 1 > buffer->capacity)
+    {
+        size_t capacity = buffer->capacity ? buffer->capacity : 1024;
+        while (buffer->size + size + 1 > capacity)
+        {
+            capacity *= 2;
+        }
+        buffer->data = realloc(buffer->data, capacity);
+        assert(buffer->data);
+        buffer->capacity = capacity;
+    }
+    memcpy(buffer->data + buffer->size, text, size);
+    buffer->size += size;
+    buffer->data[buffer->size] = '\0';
+}
+
+static void AppendLine(TextBuffer* buffer, int line, int sourceNumber)
+{
+    char directive[64];
+    int length = snprintf(directive, sizeof(directive), "#line %d %d\n", line, sourceNumber);
+    Append(buffer, directive, (size_t)length);
+}
+
+static char* CopyString(const char* text, size_t size)
+{
+    char* result = malloc(size + 1);
+    assert(result);
+    memcpy(result, text, size);
+    result[size] = '\0';
+    return result;
+}
+
+// Collapses "." and "dir/.." segments in place, so every spelling of a file maps to one dependency.
+static void NormalizePath(char* path)
+{
+    char* segments[PREPROCESSOR_MAX_DEPTH * 4];
+    int segmentCount = 0;
+    int absolute = path[0] == '/';
+
+    char* copy = CopyString(path, strlen(path));
+    for (char* segment = strtok(copy, "/"); segment; segment = strtok(NULL, "/"))
+    {
+        if (strcmp(segment, ".") == 0)
+        {
+            continue;
+        }
+        if (strcmp(segment, "..") == 0 && segmentCount > 0 && strcmp(segments[segmentCount - 1], "..") != 0)
+        {
+            --segmentCount;
+            continue;
+        }
+        if (segmentCount == (int)ArraySize(segments))
+        {
+            free(copy);
+            return;
+        }
+        segments[segmentCount++] = segment;
+    }
+
+    char* out = path;
+    if (absolute)
+    {
+        *out++ = '/';
+    }
+    for (int i = 0; i < segmentCount; ++i)
+    {
+        size_t length = strlen(segments[i]);
+        memmove(out, segments[i], length);
+        out += length;
+        if (i + 1 < segmentCount)
+        {
+            *out++ = '/';
+        }
+    }
+    *out = '\0';
+    free(copy);
+}
+
+static void FreeExpansion(ShaderExpansion* expansion)
+{
+    for (int i = 0; i < expansion->dependencyCount; ++i)
+    {
+        free(expansion->dependencies[i].path);
+    }
+    free(expansion->dependencies);
+    free(expansion->text);
+    free(expansion);
+}
+
+static int FindDependency(const ShaderExpansion* expansion, const char* path)
+{
+    for (int i = 0; i < expansion->dependencyCount; ++i)
+    {
+        if (strcmp(expansion->dependencies[i].path, path) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int AddDependency(ShaderExpansion* expansion, const char* path, uint64_t contentHash)
+{
+    if (expansion->dependencyCount == expansion->dependencyCapacity)
+    {
+        expansion->dependencyCapacity = expansion->dependencyCapacity ? expansion->dependencyCapacity * 2 : 8;
+        expansion->dependencies = realloc(expansion->dependencies,
+                                          expansion->dependencyCapacity * sizeof(ShaderDependency));
+        assert(expansion->dependencies);
+    }
+    ShaderDependency* dependency = expansion->dependencies + expansion->dependencyCount;
+    dependency->path = CopyString(path, strlen(path));
+    dependency->contentHash = contentHash;
+    return expansion->dependencyCount++;
+}
+
+// Directive name after '#' and optional blanks, or NULL if the line is not a directive.
+static const char* Directive(const char* line, const char* end)
+{
+    while (line < end && (*line == ' ' || *line == '\t'))
+    {
+        ++line;
+    }
+    if (line == end || *line != '#')
+    {
+        return NULL;
+    }
+    ++line;
+    while (line < end && (*line == ' ' || *line == '\t'))
+    {
+        ++line;
+    }
+    return line;
+}
+
+static int StartsWith(const char* text, const char* end, const char* prefix)
+{
+    size_t length = strlen(prefix);
+    return (size_t)(end - text) >= length && memcmp(text, prefix, length) == 0;
+}
+
+static void Report(const Preprocessor* preprocessor, const char* path, int line, const char* message)
+{
+    if (preprocessor->onError)
+    {
+        // Room for the whole path, which may be as long as the path buffers.
+        size_t size = strlen(path) + strlen(message) + 16;
+        char* log = malloc(size);
+        assert(log);
+        snprintf(log, size, "%s:%d: %s", path, line, message);
+        preprocessor->onError(path, "include", log, preprocessor->userData);
+        free(log);
+    }
+}
+
+// Errors are reported where they happen; callers only propagate the failure.
+static int ExpandFile(const Preprocessor* preprocessor, ShaderExpansion* expansion, const char* path, const char* text,
+                      int depth, TextBuffer* body, TextBuffer* version)
+{
+    int sourceNumber = AddDependency(expansion, path, Hash_String(text, 0));
+    if (sourceNumber > 0)
+    {
+        AppendLine(body, 1, sourceNumber);
+    }
+
+    // Includes resolve against the directory of the including file.
+    const char* slash = strrchr(path, '/');
+    size_t directoryLength = slash ? (size_t)(slash - path + 1) : 0;
+
+    int success = 1;
+    int lineNumber = 1;
+    for (const char* line = text; *line && success; ++lineNumber)
+    {
+        const char* end = strchr(line, '\n');
+        if (!end)
+        {
+            end = line + strlen(line);
+        }
+        const char* directive = Directive(line, end);
+
+        if (directive && StartsWith(directive, end, "version"))
+        {
+            // Must come first in the final source; later copies are dropped.
+            if (!version->size)
+            {
+                Append(version, line, (size_t)(end - line));
+                Append(version, "\n", 1);
+            }
+            Append(body, "\n", 1);
+        }
+        else if (directive && StartsWith(directive, end, "include"))
+        {
+            const char* open = memchr(directive, '"', (size_t)(end - directive));
+            const char* close = open ? memchr(open + 1, '"', (size_t)(end - open - 1)) : NULL;
+            if (!close)
+            {
+                Report(preprocessor, path, lineNumber, "expected #include \"file\"");
+                success = 0;
+                break;
+            }
+
+            char* includePath = malloc(directoryLength + (size_t)(close - open));
+            assert(includePath);
+            memcpy(includePath, path, directoryLength);
+            memcpy(includePath + directoryLength, open + 1, (size_t)(close - open - 1));
+            includePath[directoryLength + (size_t)(close - open - 1)] = '\0';
+            NormalizePath(includePath);
+
+            char* includeText = NULL;
+            if (FindDependency(expansion, includePath) >= 0)
+            {
+                Append(body, "\n", 1);
+            }
+            else if (depth + 1 >= PREPROCESSOR_MAX_DEPTH)
+            {
+                Report(preprocessor, path, lineNumber, "includes nested too deeply");
+                success = 0;
+            }
+            else if (!(includeText = ShaderFiles_Read(includePath)))
+            {
+                Report(preprocessor, path, lineNumber, "cannot read included file");
+                success = 0;
+            }
+            else if (ExpandFile(preprocessor, expansion, includePath, includeText, depth + 1, body, version))
+            {
+                AppendLine(body, lineNumber + 1, sourceNumber);
+            }
+            else
+            {
+                success = 0;
+            }
+            free(includeText);
+            free(includePath);
+        }
+        else
+        {
+            Append(body, line, (size_t)(end - line));
+            Append(body, "\n", 1);
+        }
+
+        line = *end ? end + 1 : end;
+    }
+
+    return success;
+}
+
+static ShaderExpansion* FindExpansion(const Preprocessor* preprocessor, const char* path)
+{
+    for (int i = 0; i < preprocessor->expansionCount; ++i)
+    {
+        ShaderExpansion* expansion = preprocessor->expansions[i];
+        if (strcmp(expansion->dependencies[0].path, path) == 0)
+        {
+            return expansion;
+        }
+    }
+    return NULL;
+}
+
+static int IsExpansionStale(const ShaderExpansion* expansion)
+{
+    for (int i = 0; i < expansion->dependencyCount; ++i)
+    {
+        const ShaderDependency* dependency = expansion->dependencies + i;
+        char* text = ShaderFiles_Read(dependency->path);
+        int changed = !text || Hash_String(text, 0) != dependency->contentHash;
+        free(text);
+        if (changed)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void Preprocessor_Init(Preprocessor* preprocessor, ShaderErrorFunc onError, void* userData)
+{
+    memset(preprocessor, 0, sizeof(*preprocessor));
+    preprocessor->onError = onError;
+    preprocessor->userData = userData;
+}
+
+void Preprocessor_Free(Preprocessor* preprocessor)
+{
+    for (int i = 0; i < preprocessor->expansionCount; ++i)
+    {
+        FreeExpansion(preprocessor->expansions[i]);
+    }
+    free(preprocessor->expansions);
+    memset(preprocessor, 0, sizeof(*preprocessor));
+}
+
+// The result stays valid until the same path is expanded again after a change, or
+// the preprocessor is freed. Returns NULL and reports through onError on failure.
+const ShaderExpansion* Preprocessor_Expand(Preprocessor* preprocessor, const char* fileName)
+{
+    char path[1024];
+    snprintf(path, sizeof(path), "%s", fileName);
+    NormalizePath(path);
+
+    ShaderExpansion* cached = FindExpansion(preprocessor, path);
+    if (cached && !IsExpansionStale(cached))
+    {
+        ++preprocessor->hitCount;
+        return cached;
+    }
+    ++preprocessor->missCount;
+
+    char* rootText = ShaderFiles_Read(path);
+    if (!rootText)
+    {
+        // Usually caught mid-save; callers retry on the next change.
+        Report(preprocessor, path, 0, "cannot read file");
+        return NULL;
+    }
+
+    ShaderExpansion* expansion = calloc(1, sizeof(ShaderExpansion));
+    assert(expansion);
+    TextBuffer body = {0};
+    TextBuffer version = {0};
+    int success = ExpandFile(preprocessor, expansion, path, rootText, 0, &body, &version);
+    if (!success)
+    {
+        free(rootText);
+        free(body.data);
+        free(version.data);
+        FreeExpansion(expansion);
+        return NULL;
+    }
+
+    if (expansion->dependencyCount == 1)
+    {
+        // Nothing was included: the file as written, so program cache keys match
+        // callers that compile it without the preprocessor.
+        expansion->text = rootText;
+    }
+    else
+    {
+        // #version first, then number the root's lines from 1 again.
+        TextBuffer text = {0};
+        if (version.size)
+        {
+            Append(&text, version.data, version.size);
+            AppendLine(&text, 1, 0);
+        }
+        Append(&text, body.data ? body.data : "", body.size);
+        expansion->text = text.data;
+        free(rootText);
+    }
+    free(body.data);
+    free(version.data);
+
+    if (cached)
+    {
+        for (int i = 0; i < preprocessor->expansionCount; ++i)
+        {
+            if (preprocessor->expansions[i] == cached)
+            {
+                preprocessor->expansions[i] = expansion;
+            }
+        }
+        FreeExpansion(cached);
+        return expansion;
+    }
+
+    if (preprocessor->expansionCount == preprocessor->expansionCapacity)
+    {
+        preprocessor->expansionCapacity = preprocessor->expansionCapacity ? preprocessor->expansionCapacity * 2 : 16;
+        preprocessor->expansions = realloc(preprocessor->expansions,
+                                           preprocessor->expansionCapacity * sizeof(ShaderExpansion*));
+        assert(preprocessor->expansions);
+    }
+    preprocessor->expansions[preprocessor->expansionCount++] = expansion;
+    return expansion;
+}
+
+// True when path was never expanded or any file it pulled in has changed since.
+int Preprocessor_IsStale(const Preprocessor* preprocessor, const char* fileName)
+{
+    char path[1024];
+    snprintf(path, sizeof(path), "%s", fileName);
+    NormalizePath(path);
+
+    const ShaderExpansion* expansion = FindExpansion(preprocessor, path);
+    return !expansion || IsExpansionStale(expansion);
+}
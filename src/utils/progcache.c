@@ -0,0 +1,348 @@
+#include "utils/progcache.h"
+#include "utils/glext.h"
+#include "utils/hash.h"
+#include "utils/utils.h"
+#include "utils/shaderstats.h"
+#include "utils/shaderbatch.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define PROGCACHE_MAGIC 0x42475250 // "PRGB"
+#define PROGCACHE_VERSION 1
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t binaryFormat;
+    uint32_t binarySize;
+    double buildSeconds;
+} ProgCacheHeader;
+
+uint64_t ProgCache_KeyFromHashes(uint64_t vertHash, uint64_t fragHash)
+{
+    // A driver update invalidates every binary, so its identity is part of the key.
+    const char* strings[] =
+    {
+        (const char*)glGetString(GL_VENDOR),
+        (const char*)glGetString(GL_RENDERER),
+        (const char*)glGetString(GL_VERSION),
+    };
+
+    uint64_t result = 0;
+    for (int i = 0; i < (int)ArraySize(strings); ++i)
+    {
+        result = Hash_String(strings[i] ? strings[i] : "", result);
+    }
+    uint64_t sourceHashes[] = {vertHash, fragHash};
+    return Hash_Bytes(sourceHashes, sizeof(sourceHashes), result);
+}
+
+uint64_t ProgCache_Key(const char* vertSrc, const char* fragSrc)
+{
+    return ProgCache_KeyFromHashes(Hash_String(vertSrc, 0), Hash_String(fragSrc, 0));
+}
+
+static void ReportLog(const ProgCache* cache, const char* name, const char* stage, GLuint object, int isProgram)
+{
+    GLint logLength = 0;
+    if (isProgram)
+    {
+        glGetProgramiv(object, GL_INFO_LOG_LENGTH, &logLength);
+    }
+    else
+    {
+        glGetShaderiv(object, GL_INFO_LOG_LENGTH, &logLength);
+    }
+    char* log = calloc(logLength + 1, 1);
+    assert(log);
+    if (isProgram)
+    {
+        glGetProgramInfoLog(object, logLength, NULL, log);
+    }
+    else
+    {
+        glGetShaderInfoLog(object, logLength, NULL, log);
+    }
+    cache->onError(name, stage, log, cache->userData);
+    free(log);
+}
+
+static GLuint CompileStage(const ProgCache* cache, const char* name, GLenum type, const char* source, int* success)
+{
+    GLuint result = glCreateShader(type);
+    glShaderSource(result, 1, &source, NULL);
+    glCompileShader(result);
+    glGetShaderiv(result, GL_COMPILE_STATUS, success);
+    if (!*success)
+    {
+        ReportLog(cache, name, type == GL_VERTEX_SHADER ? "vertex" : "fragment", result, 0);
+    }
+    return result;
+}
+
+// Each stage is timed up to its status check, which waits for the driver to finish it.
+// Failures go to the cache's error handler; a failed compile skips the link.
+static GLuint CompileAndLink(ProgCache* cache, const char* name, const char* vertSrc, const char* fragSrc,
+                             ShaderStat* stat)
+{
+    int vertOk, fragOk;
+    double start = glfwGetTime();
+    GLuint vertShdr = CompileStage(cache, name, GL_VERTEX_SHADER, vertSrc, &vertOk);
+    stat->vertSeconds = glfwGetTime() - start;
+
+    start = glfwGetTime();
+    GLuint fragShdr = CompileStage(cache, name, GL_FRAGMENT_SHADER, fragSrc, &fragOk);
+    stat->fragSeconds = glfwGetTime() - start;
+
+    GLuint program = glCreateProgram();
+    if (vertOk && fragOk)
+    {
+        start = glfwGetTime();
+        glAttachShader(program, vertShdr);
+        glAttachShader(program, fragShdr);
+        ProgCache_PrepareLink(cache, program);
+        glLinkProgram(program);
+        GLint linked;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (!linked)
+        {
+            ReportLog(cache, name, "link", program, 1);
+        }
+        stat->linkSeconds = glfwGetTime() - start;
+    }
+
+    glDeleteShader(vertShdr);
+    glDeleteShader(fragShdr);
+    return program;
+}
+
+static GLuint LoadBinary(const char* path, uint64_t key, double* buildSeconds)
+{
+    size_t size;
+    unsigned char* bytes = Utils_ReadBinaryFile(path, &size);
+    if (!bytes)
+    {
+        return 0;
+    }
+
+    const ProgCacheHeader* header = (const ProgCacheHeader*)bytes;
+    GLuint result = 0;
+    if (size >= sizeof(*header) && header->magic == PROGCACHE_MAGIC && header->version == PROGCACHE_VERSION &&
+        header->key == key && size - sizeof(*header) == header->binarySize)
+    {
+        result = glCreateProgram();
+        GLExt_Get()->ProgramBinary(result, header->binaryFormat, bytes + sizeof(*header), (GLsizei)header->binarySize);
+
+        // Drivers may refuse binaries they wrote themselves, e.g. after a hardware change.
+        GLint success;
+        glGetProgramiv(result, GL_LINK_STATUS, &success);
+        if (success)
+        {
+            *buildSeconds = header->buildSeconds;
+        }
+        else
+        {
+            glDeleteProgram(result);
+            result = 0;
+        }
+    }
+
+    free(bytes);
+    return result;
+}
+
+static int StoreBinary(const char* cacheDir, const char* path, uint64_t key, GLuint program, double buildSeconds)
+{
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+    {
+        return 0;
+    }
+
+    unsigned char* binary = malloc(length);
+    if (!binary)
+    {
+        return 0;
+    }
+    GLenum binaryFormat;
+    GLsizei binarySize = 0;
+    GLExt_Get()->GetProgramBinary(program, length, &binarySize, &binaryFormat, binary);
+
+    ProgCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = PROGCACHE_MAGIC;
+    header.version = PROGCACHE_VERSION;
+    header.key = key;
+    header.binaryFormat = binaryFormat;
+    header.binarySize = (uint32_t)binarySize;
+    header.buildSeconds = buildSeconds;
+
+    // Same scheme as the texture cache: write a unique temp file, then rename over.
+    mkdir(cacheDir, 0755);
+    char tempPath[1024];
+    int fd = -1;
+    if (binarySize > 0 && snprintf(tempPath, sizeof(tempPath), "%s.XXXXXX", path) < (int)sizeof(tempPath))
+    {
+        fd = mkstemp(tempPath);
+    }
+    if (fd < 0)
+    {
+        free(binary);
+        return 0;
+    }
+    fchmod(fd, 0644);
+
+    FILE* file = fdopen(fd, "wb");
+    int success = 0;
+    if (file)
+    {
+        success = fwrite(&header, sizeof(header), 1, file) == 1 && fwrite(binary, binarySize, 1, file) == 1;
+        success = !fclose(file) && success;
+    }
+    else
+    {
+        close(fd);
+    }
+    free(binary);
+
+    if (!success || rename(tempPath, path))
+    {
+        unlink(tempPath);
+        return 0;
+    }
+    return 1;
+}
+
+static int IsEnabled(const ProgCache* cache)
+{
+    return cache->cacheDir && GLExt_Get()->programBinary;
+}
+
+static void CachePath(const ProgCache* cache, uint64_t key, char* path, size_t pathSize)
+{
+    snprintf(path, pathSize, "%s/%016llx.bin", cache->cacheDir, (unsigned long long)key);
+}
+
+void ProgCache_Init(ProgCache* cache, const char* cacheDir)
+{
+    memset(cache, 0, sizeof(*cache));
+    cache->cacheDir = cacheDir;
+    cache->onError = ShaderBatch_PrintError;
+}
+
+void ProgCache_SetErrorHandler(ProgCache* cache, ShaderErrorFunc onError, void* userData)
+{
+    cache->onError = onError ? onError : ShaderBatch_PrintError;
+    cache->userData = userData;
+}
+
+// Returns the stored program for key, or 0 on a miss after which the caller builds it.
+GLuint ProgCache_Load(ProgCache* cache, uint64_t key)
+{
+    GLuint result = 0;
+    if (IsEnabled(cache))
+    {
+        char path[1024];
+        CachePath(cache, key, path, sizeof(path));
+        double start = glfwGetTime();
+        double buildSeconds;
+        result = LoadBinary(path, key, &buildSeconds);
+        if (result)
+        {
+            cache->savedSeconds += buildSeconds - (glfwGetTime() - start);
+        }
+    }
+
+    if (result)
+    {
+        ++cache->hitCount;
+    }
+    else
+    {
+        ++cache->missCount;
+    }
+    return result;
+}
+
+// Call before glLinkProgram on programs that will be stored.
+void ProgCache_PrepareLink(const ProgCache* cache, GLuint program)
+{
+    if (IsEnabled(cache))
+    {
+        GLExt_Get()->ProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+}
+
+// Stores a successfully linked program; buildSeconds is what a later hit will save.
+void ProgCache_Store(ProgCache* cache, uint64_t key, GLuint program, double buildSeconds)
+{
+    if (IsEnabled(cache))
+    {
+        char path[1024];
+        CachePath(cache, key, path, sizeof(path));
+        // A failed write only costs the next run a compile.
+        StoreBinary(cache->cacheDir, path, key, program, buildSeconds);
+    }
+}
+
+// Drop-in for the compile, check and link sequence. name labels the build in errors and
+// shader statistics. A failed build reports through the error handler, asks window (if
+// any) to close, and returns a program whose link status is false.
+GLuint ProgCache_Build(ProgCache* cache, const char* name, const char* vertSrc, const char* fragSrc, GLFWwindow* window)
+{
+    uint64_t key = IsEnabled(cache) ? ProgCache_Key(vertSrc, fragSrc) : 0;
+    return ProgCache_BuildWithKey(cache, name, key, vertSrc, fragSrc, window);
+}
+
+// ProgCache_Build with a key the caller already has, e.g. from ProgCache_KeyFromHashes
+// over the hashes of embedded shaders, so the sources are not hashed again.
+GLuint ProgCache_BuildWithKey(ProgCache* cache, const char* name, uint64_t key, const char* vertSrc,
+                              const char* fragSrc, GLFWwindow* window)
+{
+    ShaderStat stat = {0};
+    double start = glfwGetTime();
+    GLuint result = ProgCache_Load(cache, key);
+    if (result)
+    {
+        stat.cacheHit = 1;
+        stat.success = 1;
+        stat.totalSeconds = glfwGetTime() - start;
+        ShaderStats_Record(name, key, vertSrc, fragSrc, &stat);
+        return result;
+    }
+
+    start = glfwGetTime();
+    result = CompileAndLink(cache, name, vertSrc, fragSrc, &stat);
+    double buildSeconds = glfwGetTime() - start;
+
+    GLint success;
+    glGetProgramiv(result, GL_LINK_STATUS, &success);
+    if (success)
+    {
+        ProgCache_Store(cache, key, result, buildSeconds);
+    }
+    else if (window)
+    {
+        glfwSetWindowShouldClose(window, GLFW_TRUE);
+    }
+
+    stat.success = success;
+    stat.totalSeconds = glfwGetTime() - start;
+    ShaderStats_Record(name, key, vertSrc, fragSrc, &stat);
+    return result;
+}
+
+void ProgCache_Report(const ProgCache* cache)
+{
+    printf("Program cache: %d hits, %d misses, %.2f ms of startup saved\n",
+           cache->hitCount, cache->missCount, cache->savedSeconds * 1000.0);
+}
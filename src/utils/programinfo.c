@@ -0,0 +1,299 @@
+#include "utils/programinfo.h"
+#include "utils/hash.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+enum
+{
+    SlotKind_Empty,
+    SlotKind_Uniform,
+    SlotKind_Attribute,
+    SlotKind_Block
+};
+
+// Active names come back as "name[0]" for arrays; lookups use the plain name.
+static char* QueryName(const char* name, GLsizei length)
+{
+    if (length > 3 && strcmp(name + length - 3, "[0]") == 0)
+    {
+        length -= 3;
+    }
+    char* result = malloc((size_t)length + 1);
+    assert(result);
+    memcpy(result, name, (size_t)length);
+    result[length] = '\0';
+    return result;
+}
+
+static void Insert(ProgramInfo* info, const char* name, int kind, int index)
+{
+    uint64_t hash = Hash_String(name, 0);
+    int mask = info->slotCount - 1;
+    int slot = (int)(hash & (uint64_t)mask);
+    while (info->slots[slot].kind != SlotKind_Empty)
+    {
+        slot = (slot + 1) & mask;
+    }
+    info->slots[slot].hash = hash;
+    info->slots[slot].kind = kind;
+    info->slots[slot].index = index;
+}
+
+static int Find(const ProgramInfo* info, const char* name, int kind)
+{
+    if (!info->slotCount)
+    {
+        return -1;
+    }
+
+    uint64_t hash = Hash_String(name, 0);
+    int mask = info->slotCount - 1;
+    for (int slot = (int)(hash & (uint64_t)mask); info->slots[slot].kind != SlotKind_Empty; slot = (slot + 1) & mask)
+    {
+        const ProgramInfoSlot* entry = info->slots + slot;
+        if (entry->hash != hash || entry->kind != kind)
+        {
+            continue;
+        }
+        // Names are compared too; a 64-bit collision is unlikely, not impossible.
+        const char* candidate = kind == SlotKind_Uniform ? info->uniforms[entry->index].name :
+                                kind == SlotKind_Attribute ? info->attributes[entry->index].name :
+                                info->blocks[entry->index].name;
+        if (strcmp(candidate, name) == 0)
+        {
+            return entry->index;
+        }
+    }
+    return -1;
+}
+
+static void ReflectUniforms(ProgramInfo* info, char* name, GLint nameCapacity)
+{
+    GLint count = 0;
+    glGetProgramiv(info->program, GL_ACTIVE_UNIFORMS, &count);
+    info->uniforms = calloc(count ? count : 1, sizeof(UniformInfo));
+    assert(info->uniforms);
+
+    for (GLuint i = 0; i < (GLuint)count; ++i)
+    {
+        GLsizei length = 0;
+        GLint size;
+        GLenum type;
+        glGetActiveUniform(info->program, i, nameCapacity, &length, &size, &type, name);
+
+        // Block members are set through their buffer, not glUniform.
+        GLint location = glGetUniformLocation(info->program, name);
+        if (location < 0)
+        {
+            continue;
+        }
+
+        UniformInfo* uniform = info->uniforms + info->uniformCount++;
+        uniform->name = QueryName(name, length);
+        uniform->location = location;
+        uniform->type = type;
+        uniform->size = size;
+    }
+}
+
+static void ReflectAttributes(ProgramInfo* info, char* name, GLint nameCapacity)
+{
+    GLint count = 0;
+    glGetProgramiv(info->program, GL_ACTIVE_ATTRIBUTES, &count);
+    info->attributes = calloc(count ? count : 1, sizeof(AttributeInfo));
+    assert(info->attributes);
+
+    for (GLuint i = 0; i < (GLuint)count; ++i)
+    {
+        GLsizei length = 0;
+        AttributeInfo* attribute = info->attributes + info->attributeCount++;
+        glGetActiveAttrib(info->program, i, nameCapacity, &length, &attribute->size, &attribute->type, name);
+        attribute->name = QueryName(name, length);
+        attribute->location = glGetAttribLocation(info->program, name);
+    }
+}
+
+static void ReflectBlocks(ProgramInfo* info, char* name, GLint nameCapacity)
+{
+    GLint count = 0;
+    glGetProgramiv(info->program, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+    info->blocks = calloc(count ? count : 1, sizeof(BlockInfo));
+    assert(info->blocks);
+
+    for (GLuint i = 0; i < (GLuint)count; ++i)
+    {
+        GLsizei length = 0;
+        BlockInfo* block = info->blocks + info->blockCount++;
+        glGetActiveUniformBlockName(info->program, i, nameCapacity, &length, name);
+        block->name = QueryName(name, length);
+        block->index = i;
+        glGetActiveUniformBlockiv(info->program, i, GL_UNIFORM_BLOCK_DATA_SIZE, &block->dataSize);
+        glGetActiveUniformBlockiv(info->program, i, GL_UNIFORM_BLOCK_BINDING, &block->binding);
+    }
+}
+
+// Once after a successful link.
+void ProgramInfo_Init(ProgramInfo* info, GLuint program)
+{
+    memset(info, 0, sizeof(*info));
+    info->program = program;
+
+    GLint uniformLength = 0, attributeLength = 0, blockLength = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &uniformLength);
+    glGetProgramiv(program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &attributeLength);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &blockLength);
+    GLint nameCapacity = uniformLength;
+    nameCapacity = attributeLength > nameCapacity ? attributeLength : nameCapacity;
+    nameCapacity = blockLength > nameCapacity ? blockLength : nameCapacity;
+    char* name = malloc((size_t)nameCapacity + 1);
+    assert(name);
+
+    ReflectUniforms(info, name, nameCapacity);
+    ReflectAttributes(info, name, nameCapacity);
+    ReflectBlocks(info, name, nameCapacity);
+    free(name);
+
+    // At most half full, so probes stay short.
+    int total = info->uniformCount + info->attributeCount + info->blockCount;
+    info->slotCount = 8;
+    while (info->slotCount < total * 2)
+    {
+        info->slotCount *= 2;
+    }
+    info->slots = calloc(info->slotCount, sizeof(ProgramInfoSlot));
+    assert(info->slots);
+    for (int i = 0; i < info->uniformCount; ++i)
+    {
+        Insert(info, info->uniforms[i].name, SlotKind_Uniform, i);
+    }
+    for (int i = 0; i < info->attributeCount; ++i)
+    {
+        Insert(info, info->attributes[i].name, SlotKind_Attribute, i);
+    }
+    for (int i = 0; i < info->blockCount; ++i)
+    {
+        Insert(info, info->blocks[i].name, SlotKind_Block, i);
+    }
+}
+
+void ProgramInfo_Free(ProgramInfo* info)
+{
+    for (int i = 0; i < info->uniformCount; ++i)
+    {
+        free(info->uniforms[i].name);
+    }
+    for (int i = 0; i < info->attributeCount; ++i)
+    {
+        free(info->attributes[i].name);
+    }
+    for (int i = 0; i < info->blockCount; ++i)
+    {
+        free(info->blocks[i].name);
+    }
+    free(info->uniforms);
+    free(info->attributes);
+    free(info->blocks);
+    free(info->slots);
+    memset(info, 0, sizeof(*info));
+}
+
+// Returns a handle for the setters, or -1 if the program has no such active uniform.
+int ProgramInfo_Uniform(const ProgramInfo* info, const char* name)
+{
+    return Find(info, name, SlotKind_Uniform);
+}
+
+GLint ProgramInfo_Attribute(const ProgramInfo* info, const char* name)
+{
+    int index = Find(info, name, SlotKind_Attribute);
+    return index < 0 ? -1 : info->attributes[index].location;
+}
+
+int ProgramInfo_Block(const ProgramInfo* info, const char* name)
+{
+    return Find(info, name, SlotKind_Block);
+}
+
+void ProgramInfo_BindBlock(ProgramInfo* info, int block, GLuint binding)
+{
+    if (block < 0 || info->blocks[block].binding == (GLint)binding)
+    {
+        return;
+    }
+    glUniformBlockBinding(info->program, info->blocks[block].index, binding);
+    info->blocks[block].binding = (GLint)binding;
+}
+
+// True when the uniform exists and value differs from what it last got.
+static int Update(ProgramInfo* info, int uniform, const void* value, size_t size)
+{
+    if (uniform < 0)
+    {
+        return 0;
+    }
+    UniformInfo* entry = info->uniforms + uniform;
+    if (entry->hasValue && memcmp(entry->value, value, size) == 0)
+    {
+        ++info->skippedCount;
+        return 0;
+    }
+    memcpy(entry->value, value, size);
+    entry->hasValue = 1;
+    ++info->setCount;
+    return 1;
+}
+
+// Also sets samplers to their texture unit.
+void ProgramInfo_SetInt(ProgramInfo* info, int uniform, int value)
+{
+    if (Update(info, uniform, &value, sizeof(value)))
+    {
+        glUniform1i(info->uniforms[uniform].location, value);
+    }
+}
+
+void ProgramInfo_SetFloat(ProgramInfo* info, int uniform, float value)
+{
+    if (Update(info, uniform, &value, sizeof(value)))
+    {
+        glUniform1f(info->uniforms[uniform].location, value);
+    }
+}
+
+void ProgramInfo_SetVec2(ProgramInfo* info, int uniform, float x, float y)
+{
+    float value[] = {x, y};
+    if (Update(info, uniform, value, sizeof(value)))
+    {
+        glUniform2fv(info->uniforms[uniform].location, 1, value);
+    }
+}
+
+void ProgramInfo_SetVec3(ProgramInfo* info, int uniform, float x, float y, float z)
+{
+    float value[] = {x, y, z};
+    if (Update(info, uniform, value, sizeof(value)))
+    {
+        glUniform3fv(info->uniforms[uniform].location, 1, value);
+    }
+}
+
+void ProgramInfo_SetVec4(ProgramInfo* info, int uniform, float x, float y, float z, float w)
+{
+    float value[] = {x, y, z, w};
+    if (Update(info, uniform, value, sizeof(value)))
+    {
+        glUniform4fv(info->uniforms[uniform].location, 1, value);
+    }
+}
+
+// Column major, as GL expects.
+void ProgramInfo_SetMat4(ProgramInfo* info, int uniform, const float* matrix)
+{
+    if (Update(info, uniform, matrix, sizeof(float) * 16))
+    {
+        glUniformMatrix4fv(info->uniforms[uniform].location, 1, GL_FALSE, matrix);
+    }
+}
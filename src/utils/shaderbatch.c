@@ -0,0 +1,278 @@
+#include "utils/shaderbatch.h"
+#include "utils/glext.h"
+#include "utils/shaderstats.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+static GLuint CreateShader(GLenum type, const char* source)
+{
+    GLuint result = glCreateShader(type);
+    glShaderSource(result, 1, &source, NULL);
+    glCompileShader(result);
+    return result;
+}
+
+static void ReportLog(const ShaderBatch* batch, const BatchProgram* entry, const char* stage, const char* log)
+{
+    if (batch->onError)
+    {
+        batch->onError(entry->name, stage, log, batch->userData);
+    }
+}
+
+// Returns 1 if the shader compiled, otherwise reports its log.
+static int CheckShader(const ShaderBatch* batch, const BatchProgram* entry, GLuint shader, const char* stage)
+{
+    GLint success;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (success)
+    {
+        return 1;
+    }
+
+    GLint logLength = 0;
+    glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
+    char* log = calloc(logLength + 1, 1);
+    assert(log);
+    glGetShaderInfoLog(shader, logLength, NULL, log);
+    ReportLog(batch, entry, stage, log);
+    free(log);
+    return 0;
+}
+
+static void CheckLink(const ShaderBatch* batch, const BatchProgram* entry)
+{
+    GLint logLength = 0;
+    glGetProgramiv(entry->program, GL_INFO_LOG_LENGTH, &logLength);
+    char* log = calloc(logLength + 1, 1);
+    assert(log);
+    glGetProgramInfoLog(entry->program, logLength, NULL, log);
+    ReportLog(batch, entry, "link", log);
+    free(log);
+}
+
+// Querying GL_LINK_STATUS blocks until the driver is done with the program. A parallel
+// driver built it in the background since submission, so it took until completion was
+// first seen; otherwise the work happened inside the compile and link calls and this
+// query. Either way, frames spent waiting for Poll are not part of it.
+static void Finish(ShaderBatch* batch, BatchProgram* entry, int parallel)
+{
+    double start = glfwGetTime();
+    GLint linked;
+    glGetProgramiv(entry->program, GL_LINK_STATUS, &linked);
+    double now = glfwGetTime();
+    double buildSeconds = parallel ? now - entry->submitTime : entry->issueSeconds + (now - start);
+
+    ShaderStat stat = {.vertBytes = entry->vertBytes, .fragBytes = entry->fragBytes, .async = 1,
+                       .success = linked, .totalSeconds = buildSeconds};
+    ShaderStats_Record(entry->name, entry->key, NULL, NULL, &stat);
+    if (linked)
+    {
+        entry->state = BatchState_Ready;
+        if (batch->cache)
+        {
+            ProgCache_Store(batch->cache, entry->key, entry->program, buildSeconds);
+        }
+    }
+    else
+    {
+        // A failed compile already explains the link failure.
+        int vertOk = CheckShader(batch, entry, entry->vertShader, "vertex");
+        int fragOk = CheckShader(batch, entry, entry->fragShader, "fragment");
+        if (vertOk && fragOk)
+        {
+            CheckLink(batch, entry);
+        }
+        glDeleteProgram(entry->program);
+        entry->program = 0;
+        entry->state = BatchState_Failed;
+    }
+
+    glDeleteShader(entry->vertShader);
+    glDeleteShader(entry->fragShader);
+    entry->vertShader = 0;
+    entry->fragShader = 0;
+}
+
+void ShaderBatch_Init(ShaderBatch* batch, ProgCache* cache, ShaderErrorFunc onError, void* userData)
+{
+    memset(batch, 0, sizeof(*batch));
+    batch->cache = cache;
+    batch->onError = onError;
+    batch->userData = userData;
+
+    const GLExtensions* extensions = GLExt_Get();
+    if (extensions->parallelShaderCompile)
+    {
+        // Let the driver pick its thread count.
+        extensions->MaxShaderCompilerThreads(0xFFFFFFFF);
+    }
+}
+
+void ShaderBatch_Free(ShaderBatch* batch)
+{
+    for (int i = 0; i < batch->programCount; ++i)
+    {
+        BatchProgram* entry = batch->programs + i;
+        glDeleteShader(entry->vertShader);
+        glDeleteShader(entry->fragShader);
+        glDeleteProgram(entry->program);
+    }
+    free(batch->programs);
+    memset(batch, 0, sizeof(*batch));
+}
+
+// Returns the program's index. A program found in the cache is ready immediately;
+// others are built by the next ShaderBatch_Submit, until which the sources must stay valid.
+int ShaderBatch_Add(ShaderBatch* batch, const char* name, const char* vertSrc, const char* fragSrc)
+{
+    if (batch->programCount == batch->programCapacity)
+    {
+        batch->programCapacity = batch->programCapacity ? batch->programCapacity * 2 : 16;
+        batch->programs = realloc(batch->programs, batch->programCapacity * sizeof(BatchProgram));
+        assert(batch->programs);
+    }
+
+    BatchProgram* entry = batch->programs + batch->programCount;
+    memset(entry, 0, sizeof(*entry));
+    entry->name = name;
+    entry->vertSrc = vertSrc;
+    entry->fragSrc = fragSrc;
+    entry->vertBytes = strlen(vertSrc);
+    entry->fragBytes = strlen(fragSrc);
+    entry->state = BatchState_Queued;
+
+    if (batch->cache)
+    {
+        double start = glfwGetTime();
+        entry->key = ProgCache_Key(vertSrc, fragSrc);
+        entry->program = ProgCache_Load(batch->cache, entry->key);
+        if (entry->program)
+        {
+            entry->state = BatchState_Ready;
+            ShaderStat stat = {.cacheHit = 1, .success = 1, .totalSeconds = glfwGetTime() - start};
+            ShaderStats_Record(name, entry->key, vertSrc, fragSrc, &stat);
+        }
+    }
+
+    return batch->programCount++;
+}
+
+void ShaderBatch_Submit(ShaderBatch* batch)
+{
+    double now = glfwGetTime();
+
+    // Every compile is issued before any link so a parallel driver sees the whole batch.
+    for (int i = 0; i < batch->programCount; ++i)
+    {
+        BatchProgram* entry = batch->programs + i;
+        if (entry->state == BatchState_Queued)
+        {
+            double start = glfwGetTime();
+            entry->vertShader = CreateShader(GL_VERTEX_SHADER, entry->vertSrc);
+            entry->fragShader = CreateShader(GL_FRAGMENT_SHADER, entry->fragSrc);
+            entry->issueSeconds = glfwGetTime() - start;
+        }
+    }
+
+    for (int i = 0; i < batch->programCount; ++i)
+    {
+        BatchProgram* entry = batch->programs + i;
+        if (entry->state != BatchState_Queued)
+        {
+            continue;
+        }
+        double start = glfwGetTime();
+        entry->program = glCreateProgram();
+        glAttachShader(entry->program, entry->vertShader);
+        glAttachShader(entry->program, entry->fragShader);
+        if (batch->cache)
+        {
+            ProgCache_PrepareLink(batch->cache, entry->program);
+        }
+        glLinkProgram(entry->program);
+        entry->issueSeconds += glfwGetTime() - start;
+        entry->state = BatchState_Compiling;
+        entry->submitTime = now;
+        entry->vertSrc = NULL;
+        entry->fragSrc = NULL;
+    }
+}
+
+// Never waits on the driver when parallel compile is available. Returns how many
+// programs are still compiling.
+int ShaderBatch_Poll(ShaderBatch* batch)
+{
+    int parallel = GLExt_Get()->parallelShaderCompile;
+    int finishedBlocking = 0;
+    int result = 0;
+
+    for (int i = 0; i < batch->programCount; ++i)
+    {
+        BatchProgram* entry = batch->programs + i;
+        if (entry->state != BatchState_Compiling)
+        {
+            continue;
+        }
+
+        GLint complete = 0;
+        if (parallel)
+        {
+            glGetProgramiv(entry->program, GL_COMPLETION_STATUS_KHR, &complete);
+        }
+        else
+        {
+            complete = !finishedBlocking;
+            finishedBlocking = 1;
+        }
+
+        if (complete)
+        {
+            Finish(batch, entry, parallel);
+        }
+        else
+        {
+            ++result;
+        }
+    }
+    return result;
+}
+
+void ShaderBatch_Wait(ShaderBatch* batch)
+{
+    int parallel = GLExt_Get()->parallelShaderCompile;
+    for (int i = 0; i < batch->programCount; ++i)
+    {
+        if (batch->programs[i].state == BatchState_Compiling)
+        {
+            Finish(batch, batch->programs + i, parallel);
+        }
+    }
+}
+
+// 0 until the program is ready, and for good if it failed.
+GLuint ShaderBatch_Program(const ShaderBatch* batch, int index)
+{
+    const BatchProgram* entry = batch->programs + index;
+    return entry->state == BatchState_Ready ? entry->program : 0;
+}
+
+// Hands a ready program over to the caller; the batch will no longer delete it.
+GLuint ShaderBatch_Take(ShaderBatch* batch, int index)
+{
+    GLuint result = ShaderBatch_Program(batch, index);
+    if (result)
+    {
+        batch->programs[index].program = 0;
+    }
+    return result;
+}
+
+// Default error handler: the log goes to stderr and nothing waits for input.
+void ShaderBatch_PrintError(const char* name, const char* stage, const char* log, void* userData)
+{
+    fprintf(stderr, "Shader error in %s (%s): %s\n", name ? name : "program", stage, log);
+}
@@ -0,0 +1,60 @@
+#include "utils/shaderfiles.h"
+#include "utils/utils.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const EmbeddedShader* embedded;
+static int embeddedCount;
+static int preferDisk;
+
+// Call once at startup with the example's generated table. Setting SHADERS_FROM_DISK=1
+// in the environment reads the files on disk instead, e.g. while editing them.
+void ShaderFiles_Register(const EmbeddedShader* shaders, int count)
+{
+    embedded = shaders;
+    embeddedCount = count;
+    const char* fromDisk = getenv("SHADERS_FROM_DISK");
+    preferDisk = fromDisk && *fromDisk && strcmp(fromDisk, "0") != 0;
+}
+
+void ShaderFiles_PreferDisk(int value)
+{
+    preferDisk = value;
+}
+
+// NULL when the name is not compiled in or disk files are preferred.
+const EmbeddedShader* ShaderFiles_Find(const char* name)
+{
+    if (preferDisk)
+    {
+        return NULL;
+    }
+    for (int i = 0; i < embeddedCount; ++i)
+    {
+        if (strcmp(embedded[i].name, name) == 0)
+        {
+            return embedded + i;
+        }
+    }
+    return NULL;
+}
+
+// Same contract as Utils_ReadTextFile: the caller frees the result. Names that are
+// not compiled in are read from disk.
+char* ShaderFiles_Read(const char* name)
+{
+    const EmbeddedShader* shader = ShaderFiles_Find(name);
+    if (!shader)
+    {
+        return Utils_ReadTextFile(name);
+    }
+
+    size_t size = strlen(shader->source) + 1;
+    char* result = malloc(size);
+    if (result)
+    {
+        memcpy(result, shader->source, size);
+    }
+    return result;
+}
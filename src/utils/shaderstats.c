@@ -0,0 +1,153 @@
+#include "utils/shaderstats.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+// Programs are built on the render thread only, so the list needs no lock.
+static ShaderStat* stats;
+static int statCount;
+static int statCapacity;
+static char* exitJsonPath;
+
+// Fills in the name and key of stat, and the source sizes unless the sources are NULL, then appends a copy.
+void ShaderStats_Record(const char* name, uint64_t key, const char* vertSrc, const char* fragSrc, ShaderStat* stat)
+{
+    snprintf(stat->name, sizeof(stat->name), "%s", name ? name : "program");
+    stat->key = key;
+    if (vertSrc && fragSrc)
+    {
+        stat->vertBytes = strlen(vertSrc);
+        stat->fragBytes = strlen(fragSrc);
+    }
+
+    if (statCount == statCapacity)
+    {
+        statCapacity = statCapacity ? statCapacity * 2 : 32;
+        stats = realloc(stats, statCapacity * sizeof(ShaderStat));
+        assert(stats);
+    }
+    stats[statCount++] = *stat;
+}
+
+static int CompareTotal(const void* a, const void* b)
+{
+    double left = ((const ShaderStat*)a)->totalSeconds;
+    double right = ((const ShaderStat*)b)->totalSeconds;
+    return left < right ? 1 : left > right ? -1 : 0;
+}
+
+// Slowest first, then totals.
+void ShaderStats_Print(FILE* file)
+{
+    qsort(stats, statCount, sizeof(ShaderStat), CompareTotal);
+
+    double total = 0.0;
+    int hitCount = 0;
+    fprintf(file, "Shader builds, slowest first (ms):\n");
+    fprintf(file, "  %8s %8s %8s %8s %7s %7s  %-6s %s\n", "total", "vertex", "fragment", "link", "vert B", "frag B", "", "name");
+    for (int i = 0; i < statCount; ++i)
+    {
+        const ShaderStat* stat = stats + i;
+        const char* kind = stat->cacheHit ? "cached" : stat->async ? "async" : "";
+        if (*kind)
+        {
+            // No per-stage times for these.
+            fprintf(file, "  %8.2f %8s %8s %8s", stat->totalSeconds * 1000.0, "-", "-", "-");
+        }
+        else
+        {
+            fprintf(file, "  %8.2f %8.2f %8.2f %8.2f", stat->totalSeconds * 1000.0, stat->vertSeconds * 1000.0,
+                    stat->fragSeconds * 1000.0, stat->linkSeconds * 1000.0);
+        }
+        fprintf(file, " %7zu %7zu  %-6s %s%s\n", stat->vertBytes, stat->fragBytes, kind, stat->name,
+                stat->success ? "" : " (failed)");
+        total += stat->totalSeconds;
+        hitCount += stat->cacheHit;
+    }
+    fprintf(file, "  %d programs, %d from the cache, %.2f ms in total\n", statCount, hitCount, total * 1000.0);
+}
+
+static void WriteJsonString(FILE* file, const char* text)
+{
+    fputc('"', file);
+    for (const unsigned char* c = (const unsigned char*)text; *c; ++c)
+    {
+        if (*c == '"' || *c == '\\')
+        {
+            fprintf(file, "\\%c", *c);
+        }
+        else if (*c < 0x20)
+        {
+            fprintf(file, "\\u%04x", *c);
+        }
+        else
+        {
+            fputc(*c, file);
+        }
+    }
+    fputc('"', file);
+}
+
+// Times in milliseconds, in the order the programs were built.
+int ShaderStats_WriteJson(const char* path)
+{
+    FILE* file = fopen(path, "w");
+    if (!file)
+    {
+        return 0;
+    }
+
+    fprintf(file, "[\n");
+    for (int i = 0; i < statCount; ++i)
+    {
+        const ShaderStat* stat = stats + i;
+        fprintf(file, "  {\"name\": ");
+        WriteJsonString(file, stat->name);
+        fprintf(file, ", \"key\": \"%016llx\", \"vertBytes\": %zu, \"fragBytes\": %zu, "
+                      "\"vertMs\": %.3f, \"fragMs\": %.3f, \"linkMs\": %.3f, \"totalMs\": %.3f, "
+                      "\"cacheHit\": %s, \"async\": %s, \"success\": %s}%s\n",
+                (unsigned long long)stat->key, stat->vertBytes, stat->fragBytes,
+                stat->vertSeconds * 1000.0, stat->fragSeconds * 1000.0, stat->linkSeconds * 1000.0,
+                stat->totalSeconds * 1000.0, stat->cacheHit ? "true" : "false", stat->async ? "true" : "false",
+                stat->success ? "true" : "false", i + 1 < statCount ? "," : "");
+    }
+    fprintf(file, "]\n");
+    return !fclose(file);
+}
+
+static void ReportAtExit(void)
+{
+    if (exitJsonPath)
+    {
+        ShaderStats_WriteJson(exitJsonPath);
+        free(exitJsonPath);
+        exitJsonPath = NULL;
+    }
+    else
+    {
+        ShaderStats_Print(stdout);
+    }
+    free(stats);
+    stats = NULL;
+    statCount = statCapacity = 0;
+}
+
+// Prints the table when the process exits, or writes JSON to jsonPath if given.
+void ShaderStats_ReportAtExit(const char* jsonPath)
+{
+    static int registered;
+    free(exitJsonPath);
+    exitJsonPath = NULL;
+    if (jsonPath)
+    {
+        exitJsonPath = malloc(strlen(jsonPath) + 1);
+        assert(exitJsonPath);
+        strcpy(exitJsonPath, jsonPath);
+    }
+    if (!registered)
+    {
+        atexit(ReportAtExit);
+        registered = 1;
+    }
+}
@@ -0,0 +1,277 @@
+#include "utils/shadervariants.h"
+#include "utils/hash.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define SHADERVARIANTS_MAX_DEFINES 32
+
+static char* CopyString(const char* text, size_t size)
+{
+    char* result = malloc(size + 1);
+    assert(result);
+    memcpy(result, text, size);
+    result[size] = '\0';
+    return result;
+}
+
+static char* Trim(char* text)
+{
+    while (*text == ' ' || *text == '\t')
+    {
+        ++text;
+    }
+    char* end = text + strlen(text);
+    while (end > text && (end[-1] == ' ' || end[-1] == '\t'))
+    {
+        *--end = '\0';
+    }
+    return text;
+}
+
+static size_t NameLength(const char* define)
+{
+    const char* equals = strchr(define, '=');
+    return equals ? (size_t)(equals - define) : strlen(define);
+}
+
+static int CompareDefines(const void* a, const void* b)
+{
+    const char* left = *(const char* const*)a;
+    const char* right = *(const char* const*)b;
+    size_t leftLength = NameLength(left);
+    size_t rightLength = NameLength(right);
+    int result = strncmp(left, right, leftLength < rightLength ? leftLength : rightLength);
+    return result ? result : (int)leftLength - (int)rightLength;
+}
+
+// Sorted by name with blanks around entries dropped; a name given twice keeps its last value.
+static char* Canonicalize(const char* defines)
+{
+    char* copy = CopyString(defines, strlen(defines));
+    char* entries[SHADERVARIANTS_MAX_DEFINES];
+    int entryCount = 0;
+
+    for (char* entry = strtok(copy, ";"); entry; entry = strtok(NULL, ";"))
+    {
+        entry = Trim(entry);
+        if (!*entry)
+        {
+            continue;
+        }
+        int replaced = 0;
+        for (int i = 0; i < entryCount && !replaced; ++i)
+        {
+            if (CompareDefines(&entries[i], &entry) == 0)
+            {
+                entries[i] = entry;
+                replaced = 1;
+            }
+        }
+        if (!replaced && entryCount < SHADERVARIANTS_MAX_DEFINES)
+        {
+            entries[entryCount++] = entry;
+        }
+    }
+    qsort(entries, entryCount, sizeof(char*), CompareDefines);
+
+    size_t size = 1;
+    for (int i = 0; i < entryCount; ++i)
+    {
+        size += strlen(entries[i]) + 1;
+    }
+    char* result = calloc(size, 1);
+    assert(result);
+    for (int i = 0; i < entryCount; ++i)
+    {
+        if (i)
+        {
+            strcat(result, ";");
+        }
+        strcat(result, entries[i]);
+    }
+    free(copy);
+    return result;
+}
+
+// The defines go right after #version, which must stay first, and #line puts the
+// source's own numbering back for compiler errors.
+static char* InjectDefines(const char* source, const char* defines)
+{
+    const char* insert = source;
+    int versionLine = 0;
+    int lineNumber = 1;
+    for (const char* line = source; *line; ++lineNumber)
+    {
+        const char* text = line + strspn(line, " \t");
+        const char* end = strchr(line, '\n');
+        if (*text == '#' && strncmp(text + 1 + strspn(text + 1, " \t"), "version", 7) == 0)
+        {
+            insert = end ? end + 1 : line + strlen(line);
+            versionLine = lineNumber;
+            break;
+        }
+        if (!end)
+        {
+            break;
+        }
+        line = end + 1;
+    }
+
+    // "#define " and a newline per entry, plus the #line directive.
+    size_t entryCount = 1;
+    for (const char* c = defines; *c; ++c)
+    {
+        entryCount += *c == ';';
+    }
+    size_t size = strlen(source) + strlen(defines) + entryCount * 9 + 32;
+    char* result = malloc(size);
+    assert(result);
+    size_t length = (size_t)(insert - source);
+    memcpy(result, source, length);
+    if (length && result[length - 1] != '\n')
+    {
+        result[length++] = '\n';
+    }
+
+    char* copy = CopyString(defines, strlen(defines));
+    for (char* entry = strtok(copy, ";"); entry; entry = strtok(NULL, ";"))
+    {
+        char* equals = strchr(entry, '=');
+        if (equals)
+        {
+            *equals = ' ';
+        }
+        length += (size_t)snprintf(result + length, size - length, "#define %s\n", entry);
+    }
+    free(copy);
+
+    length += (size_t)snprintf(result + length, size - length, "#line %d 0\n", versionLine + 1);
+    snprintf(result + length, size - length, "%s", insert);
+    return result;
+}
+
+void ShaderVariants_Init(ShaderVariants* variants, const char* name, const char* vertSrc, const char* fragSrc,
+                         ProgCache* cache, ShaderErrorFunc onError, void* userData)
+{
+    memset(variants, 0, sizeof(*variants));
+    variants->name = CopyString(name, strlen(name));
+    variants->vertSrc = CopyString(vertSrc, strlen(vertSrc));
+    variants->fragSrc = CopyString(fragSrc, strlen(fragSrc));
+    ShaderBatch_Init(&variants->batch, cache, onError, userData);
+}
+
+// Deletes every variant's program.
+void ShaderVariants_Free(ShaderVariants* variants)
+{
+    ShaderBatch_Free(&variants->batch);
+    for (int i = 0; i < variants->variantCount; ++i)
+    {
+        ShaderVariant* variant = variants->variants + i;
+        free(variant->defines);
+        free(variant->name);
+        free(variant->vertSrc);
+        free(variant->fragSrc);
+    }
+    free(variants->variants);
+    free(variants->name);
+    free(variants->vertSrc);
+    free(variants->fragSrc);
+    memset(variants, 0, sizeof(*variants));
+}
+
+// defines is a ';' separated list of NAME or NAME=value. Returns a handle; equal
+// define sets return the same handle. Nothing is compiled yet.
+int ShaderVariants_Declare(ShaderVariants* variants, const char* defines)
+{
+    char* canonical = Canonicalize(defines ? defines : "");
+    uint64_t key = Hash_String(canonical, 0);
+    for (int i = 0; i < variants->variantCount; ++i)
+    {
+        if (variants->variants[i].key == key && strcmp(variants->variants[i].defines, canonical) == 0)
+        {
+            free(canonical);
+            return i;
+        }
+    }
+
+    if (variants->variantCount == variants->variantCapacity)
+    {
+        variants->variantCapacity = variants->variantCapacity ? variants->variantCapacity * 2 : 8;
+        variants->variants = realloc(variants->variants, variants->variantCapacity * sizeof(ShaderVariant));
+        assert(variants->variants);
+    }
+
+    ShaderVariant* variant = variants->variants + variants->variantCount;
+    memset(variant, 0, sizeof(*variant));
+    variant->defines = canonical;
+    variant->key = key;
+    size_t nameSize = strlen(variants->name) + strlen(canonical) + 4;
+    variant->name = malloc(nameSize);
+    assert(variant->name);
+    snprintf(variant->name, nameSize, "%s [%s]", variants->name, canonical);
+    variant->batchIndex = -1;
+
+    return variants->variantCount++;
+}
+
+// The text ShaderVariants_Get compiles for source under defines, for tools that
+// build variants ahead of time and need the same program cache keys. Caller frees.
+char* ShaderVariants_Source(const char* source, const char* defines)
+{
+    char* canonical = Canonicalize(defines ? defines : "");
+    char* result = InjectDefines(source, canonical);
+    free(canonical);
+    return result;
+}
+
+static void Queue(ShaderVariants* variants, ShaderVariant* variant)
+{
+    variant->vertSrc = InjectDefines(variants->vertSrc, variant->defines);
+    variant->fragSrc = InjectDefines(variants->fragSrc, variant->defines);
+    variant->batchIndex = ShaderBatch_Add(&variants->batch, variant->name, variant->vertSrc, variant->fragSrc);
+}
+
+// Starts building every declared variant not built yet, without waiting for them.
+void ShaderVariants_Precompile(ShaderVariants* variants)
+{
+    for (int i = 0; i < variants->variantCount; ++i)
+    {
+        if (variants->variants[i].batchIndex < 0)
+        {
+            Queue(variants, variants->variants + i);
+        }
+    }
+    ShaderBatch_Submit(&variants->batch);
+}
+
+// Once per frame while variants are precompiling. Returns how many are still compiling.
+int ShaderVariants_Poll(ShaderVariants* variants)
+{
+    return ShaderBatch_Poll(&variants->batch);
+}
+
+// 0 until the variant is built, and for good if it failed.
+GLuint ShaderVariants_Program(const ShaderVariants* variants, int handle)
+{
+    const ShaderVariant* variant = variants->variants + handle;
+    return variant->batchIndex < 0 ? 0 : ShaderBatch_Program(&variants->batch, variant->batchIndex);
+}
+
+// Builds the variant now if nobody has yet, waiting for it if needed. 0 if it failed.
+GLuint ShaderVariants_Get(ShaderVariants* variants, int handle)
+{
+    ShaderVariant* variant = variants->variants + handle;
+    if (variant->batchIndex < 0)
+    {
+        Queue(variants, variant);
+        ShaderBatch_Submit(&variants->batch);
+    }
+    if (!ShaderBatch_Program(&variants->batch, variant->batchIndex))
+    {
+        ShaderBatch_Wait(&variants->batch);
+    }
+    return ShaderBatch_Program(&variants->batch, variant->batchIndex);
+}
@@ -0,0 +1,101 @@
+#include "utils/std140.h"
+
+#include <string.h>
+
+static void Write(Std140Writer* writer, size_t alignment, const void* value, size_t size)
+{
+    size_t offset = (writer->offset + alignment - 1) & ~(alignment - 1);
+    if (writer->data)
+    {
+        if (offset + size > writer->capacity)
+        {
+            writer->overflow = 1;
+            return;
+        }
+        memcpy(writer->data + offset, value, size);
+    }
+    writer->offset = offset + size;
+}
+
+static void Align(Std140Writer* writer, size_t alignment)
+{
+    writer->offset = (writer->offset + alignment - 1) & ~(alignment - 1);
+}
+
+void Std140_Init(Std140Writer* writer, void* data, size_t capacity)
+{
+    writer->data = data;
+    writer->capacity = capacity;
+    writer->offset = 0;
+    writer->overflow = 0;
+}
+
+void Std140_Int(Std140Writer* writer, int value)
+{
+    Write(writer, 4, &value, sizeof(value));
+}
+
+void Std140_Float(Std140Writer* writer, float value)
+{
+    Write(writer, 4, &value, sizeof(value));
+}
+
+void Std140_Vec2(Std140Writer* writer, const float* value)
+{
+    Write(writer, 8, value, sizeof(float) * 2);
+}
+
+// A vec3 is aligned like a vec4, but a following scalar may use its fourth slot.
+void Std140_Vec3(Std140Writer* writer, const float* value)
+{
+    Write(writer, 16, value, sizeof(float) * 3);
+}
+
+void Std140_Vec4(Std140Writer* writer, const float* value)
+{
+    Write(writer, 16, value, sizeof(float) * 4);
+}
+
+// Column major: four vec4 columns.
+void Std140_Mat4(Std140Writer* writer, const float* matrix)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        Std140_Vec4(writer, matrix + i * 4);
+    }
+}
+
+// Every array element takes a full vec4 slot.
+void Std140_FloatArray(Std140Writer* writer, const float* values, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        float element[4] = {values[i], 0.0f, 0.0f, 0.0f};
+        Std140_Vec4(writer, element);
+    }
+}
+
+void Std140_Vec4Array(Std140Writer* writer, const float* values, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        Std140_Vec4(writer, values + i * 4);
+    }
+}
+
+// Structs start and end on a vec4 boundary.
+void Std140_BeginStruct(Std140Writer* writer)
+{
+    Align(writer, 16);
+}
+
+void Std140_EndStruct(Std140Writer* writer)
+{
+    Align(writer, 16);
+}
+
+// The block's data size: everything written, rounded up to a vec4.
+size_t Std140_Size(const Std140Writer* writer)
+{
+    return (writer->offset + 15) & ~(size_t)15;
+}
@@ -0,0 +1,119 @@
+#include "utils/streamring.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// segmentSize is the most geometry one frame may write.
+void StreamRing_Init(StreamRing* ring, size_t segmentSize)
+{
+    memset(ring, 0, sizeof(*ring));
+    ring->segmentSize = segmentSize;
+    ring->segment = STREAMRING_SEGMENTS - 1;
+
+    // The only allocation: from here on the storage is rewritten in place.
+    glGenBuffers(1, &ring->buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, ring->buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)(segmentSize * STREAMRING_SEGMENTS), NULL, GL_STREAM_DRAW);
+}
+
+void StreamRing_Free(StreamRing* ring)
+{
+    StreamRing_Commit(ring);
+    for (int i = 0; i < STREAMRING_SEGMENTS; ++i)
+    {
+        if (ring->fences[i])
+        {
+            glDeleteSync(ring->fences[i]);
+        }
+    }
+    glDeleteBuffers(1, &ring->buffer);
+    memset(ring, 0, sizeof(*ring));
+}
+
+// Moves on to the next segment, waiting only if the GPU has not finished the frame
+// that last used it.
+void StreamRing_BeginFrame(StreamRing* ring)
+{
+    ring->segment = (ring->segment + 1) % STREAMRING_SEGMENTS;
+    GLsync fence = ring->fences[ring->segment];
+    if (fence)
+    {
+        if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+        {
+            ++ring->waitCount;
+            glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+        }
+        glDeleteSync(fence);
+        ring->fences[ring->segment] = NULL;
+    }
+    ring->head = 0;
+}
+
+// Returns where to write size bytes and their offset in the buffer for attribute
+// pointers or draw offsets, or NULL when the frame's segment is full. alignment is
+// usually the vertex size, so the offset also works as a base vertex.
+void* StreamRing_Alloc(StreamRing* ring, size_t size, size_t alignment, GLintptr* offset)
+{
+    // Aligned within the whole buffer, since segments need not start on a vertex boundary.
+    size_t base = ring->segment * ring->segmentSize;
+    size_t start = ring->head;
+    if (alignment > 1)
+    {
+        start = (base + start + alignment - 1) / alignment * alignment - base;
+    }
+    if (start + size > ring->segmentSize)
+    {
+        ++ring->overflowCount;
+        return NULL;
+    }
+
+    // Maps the rest of the segment at once; writes after a commit get a fresh mapping.
+    if (!ring->mapped)
+    {
+        ring->mappedStart = start;
+        glBindBuffer(GL_COPY_WRITE_BUFFER, ring->buffer);
+        ring->mapped = glMapBufferRange(GL_COPY_WRITE_BUFFER, (GLintptr)(base + start),
+                                        (GLsizeiptr)(ring->segmentSize - start),
+                                        GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT |
+                                        GL_MAP_FLUSH_EXPLICIT_BIT);
+        ++ring->mapCount;
+        if (!ring->mapped)
+        {
+            return NULL;
+        }
+    }
+
+    ring->head = start + size;
+    *offset = (GLintptr)(base + start);
+    return ring->mapped + (start - ring->mappedStart);
+}
+
+// Flushes what was written and unmaps; GL 3.3 cannot draw from a mapped buffer, so
+// call it before the draws that read this frame's data.
+void StreamRing_Commit(StreamRing* ring)
+{
+    if (!ring->mapped)
+    {
+        return;
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, ring->buffer);
+    if (ring->head > ring->mappedStart)
+    {
+        glFlushMappedBufferRange(GL_COPY_WRITE_BUFFER, 0, (GLsizeiptr)(ring->head - ring->mappedStart));
+    }
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    ring->mapped = NULL;
+}
+
+// After the frame's last draw that reads from the ring.
+void StreamRing_EndFrame(StreamRing* ring)
+{
+    StreamRing_Commit(ring);
+    ring->fences[ring->segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void StreamRing_Report(const StreamRing* ring)
+{
+    printf("Stream ring: %d maps, %d frames waited on the GPU, %d allocations did not fit\n",
+           ring->mapCount, ring->waitCount, ring->overflowCount);
+}
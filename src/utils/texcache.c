@@ -0,0 +1,285 @@
+#include "utils/texcache.h"
+#include "utils/hash.h"
+#include "utils/utils.h"
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define TEXCACHE_MAGIC 0x43584554 // "TEXC"
+#define TEXCACHE_VERSION 2
+#define TEXCACHE_ALIGNMENT 64
+
+typedef struct
+{
+    int32_t width;
+    int32_t height;
+    uint64_t offset;
+    uint64_t size;
+} TexCacheLevel;
+
+// Written in native byte order; the cache is local to the machine that cooked it.
+typedef struct
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    int64_t sourceMtime;
+    uint64_t sourceSize;
+    uint64_t contentHash;
+    int32_t width;
+    int32_t height;
+    int32_t channelCount;
+    int32_t flags;
+    int32_t format;
+    int32_t levelCount;
+    TexCacheLevel levels[IMAGE_MAX_LEVELS];
+    uint64_t dataOffset;
+    uint64_t dataSize;
+} TexCacheHeader;
+
+static uint64_t CacheKey(const char* fileName, int flags, ImageFormat format, BcnQuality quality)
+{
+    uint64_t options = (uint64_t)flags | ((uint64_t)format << 16) | ((uint64_t)quality << 32);
+    return Hash_String(fileName, options);
+}
+
+static int IsHeaderValid(const TexCacheHeader* header, uint64_t key, size_t fileSize)
+{
+    if (header->magic != TEXCACHE_MAGIC || header->version != TEXCACHE_VERSION || header->key != key)
+    {
+        return 0;
+    }
+    if (header->levelCount < 1 || header->levelCount > IMAGE_MAX_LEVELS)
+    {
+        return 0;
+    }
+    if (header->dataOffset + header->dataSize > fileSize)
+    {
+        return 0;
+    }
+    for (int i = 0; i < header->levelCount; ++i)
+    {
+        if (header->levels[i].offset + header->levels[i].size > header->dataSize)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// A matching mtime and size is trusted; otherwise the source bytes decide.
+static int IsSourceCurrent(const TexCacheHeader* header, const char* fileName, const struct stat* sourceStat,
+                           int64_t* refreshedMtime)
+{
+    *refreshedMtime = 0;
+    if (header->sourceSize != (uint64_t)sourceStat->st_size)
+    {
+        return 0;
+    }
+    if (header->sourceMtime == (int64_t)sourceStat->st_mtime)
+    {
+        return 1;
+    }
+
+    size_t size;
+    unsigned char* bytes = Utils_ReadBinaryFile(fileName, &size);
+    if (!bytes)
+    {
+        return 0;
+    }
+    int result = Hash_Bytes(bytes, size, 0) == header->contentHash;
+    free(bytes);
+
+    if (result)
+    {
+        *refreshedMtime = (int64_t)sourceStat->st_mtime;
+    }
+    return result;
+}
+
+static int MapCacheFile(const char* path, uint64_t key, const char* fileName, const struct stat* sourceStat,
+                        Image* image, uint64_t* sourceHash)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return 0;
+    }
+
+    struct stat cacheStat;
+    if (fstat(fd, &cacheStat) || (size_t)cacheStat.st_size < sizeof(TexCacheHeader))
+    {
+        close(fd);
+        return 0;
+    }
+
+    size_t mappingSize = (size_t)cacheStat.st_size;
+    void* mapping = mmap(NULL, mappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        return 0;
+    }
+
+    const TexCacheHeader* header = mapping;
+    int64_t refreshedMtime;
+    if (!IsHeaderValid(header, key, mappingSize) || !IsSourceCurrent(header, fileName, sourceStat, &refreshedMtime))
+    {
+        munmap(mapping, mappingSize);
+        return 0;
+    }
+
+    if (refreshedMtime)
+    {
+        // Touched but unchanged source: remember the new mtime so the next run skips hashing.
+        fd = open(path, O_WRONLY);
+        if (fd >= 0)
+        {
+            pwrite(fd, &refreshedMtime, sizeof(refreshedMtime), offsetof(TexCacheHeader, sourceMtime));
+            close(fd);
+        }
+    }
+
+    memset(image, 0, sizeof(*image));
+    image->width = header->width;
+    image->height = header->height;
+    image->channelCount = header->channelCount;
+    image->flags = header->flags;
+    image->format = (ImageFormat)header->format;
+    image->levelCount = header->levelCount;
+    for (int i = 0; i < header->levelCount; ++i)
+    {
+        image->levels[i].width = header->levels[i].width;
+        image->levels[i].height = header->levels[i].height;
+        image->levels[i].offset = (size_t)header->levels[i].offset;
+        image->levels[i].size = (size_t)header->levels[i].size;
+    }
+    image->data = (unsigned char*)mapping + header->dataOffset;
+    image->dataSize = (size_t)header->dataSize;
+    image->mapping = mapping;
+    image->mappingSize = mappingSize;
+    *sourceHash = header->contentHash;
+
+    return 1;
+}
+
+static int WriteCacheFile(const char* cacheDir, const char* path, const TexCacheHeader* header, const Image* image)
+{
+    mkdir(cacheDir, 0755);
+
+    // Written under a unique name and renamed, so readers never map a partial file.
+    char tempPath[1024];
+    if (snprintf(tempPath, sizeof(tempPath), "%s.XXXXXX", path) >= (int)sizeof(tempPath))
+    {
+        return 0;
+    }
+    int fd = mkstemp(tempPath);
+    if (fd < 0)
+    {
+        return 0;
+    }
+    fchmod(fd, 0644);
+
+    FILE* file = fdopen(fd, "wb");
+    if (!file)
+    {
+        close(fd);
+        unlink(tempPath);
+        return 0;
+    }
+
+    static const unsigned char padding[TEXCACHE_ALIGNMENT] = {0};
+    size_t paddingSize = (size_t)header->dataOffset - sizeof(*header);
+    int success = fwrite(header, sizeof(*header), 1, file) == 1 &&
+                  fwrite(padding, 1, paddingSize, file) == paddingSize &&
+                  fwrite(image->data, image->dataSize, 1, file) == 1;
+    success = !fclose(file) && success;
+
+    if (!success || rename(tempPath, path))
+    {
+        unlink(tempPath);
+        return 0;
+    }
+    return 1;
+}
+
+int TexCache_Load(const char* cacheDir, const char* fileName, int flags,
+                  ImageFormat format, BcnQuality quality, int threadCount, Image* image, int* hit,
+                  uint64_t* sourceHash)
+{
+    *hit = 0;
+
+    struct stat sourceStat;
+    if (stat(fileName, &sourceStat))
+    {
+        return 0;
+    }
+
+    uint64_t key = CacheKey(fileName, flags, format, quality);
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%016llx.tex", cacheDir, (unsigned long long)key);
+
+    if (MapCacheFile(path, key, fileName, &sourceStat, image, sourceHash))
+    {
+        *hit = 1;
+        return 1;
+    }
+
+    size_t size;
+    unsigned char* bytes = Utils_ReadBinaryFile(fileName, &size);
+    if (!bytes)
+    {
+        return 0;
+    }
+
+    *sourceHash = Hash_Bytes(bytes, size, 0);
+    int success = Image_LoadFromMemory(bytes, size, flags, image);
+    if (success && format != ImageFormat_Uncompressed)
+    {
+        success = Bcn_CompressImage(image, format, quality, threadCount);
+    }
+
+    if (success)
+    {
+        TexCacheHeader header;
+        memset(&header, 0, sizeof(header));
+        header.magic = TEXCACHE_MAGIC;
+        header.version = TEXCACHE_VERSION;
+        header.key = key;
+        header.sourceMtime = (int64_t)sourceStat.st_mtime;
+        header.sourceSize = (uint64_t)size;
+        header.contentHash = *sourceHash;
+        header.width = image->width;
+        header.height = image->height;
+        header.channelCount = image->channelCount;
+        header.flags = image->flags;
+        header.format = image->format;
+        header.levelCount = image->levelCount;
+        for (int i = 0; i < image->levelCount; ++i)
+        {
+            header.levels[i].width = image->levels[i].width;
+            header.levels[i].height = image->levels[i].height;
+            header.levels[i].offset = image->levels[i].offset;
+            header.levels[i].size = image->levels[i].size;
+        }
+        header.dataOffset = (sizeof(header) + TEXCACHE_ALIGNMENT - 1) / TEXCACHE_ALIGNMENT * TEXCACHE_ALIGNMENT;
+        header.dataSize = image->dataSize;
+
+        // A failed write only costs the next run a decode.
+        WriteCacheFile(cacheDir, path, &header, image);
+    }
+    else
+    {
+        Image_Free(image);
+    }
+
+    free(bytes);
+    return success;
+}
@@ -0,0 +1,124 @@
+#include "utils/texregistry.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+void TexRegistry_Init(TexRegistry* registry)
+{
+    memset(registry, 0, sizeof(*registry));
+}
+
+void TexRegistry_Free(TexRegistry* registry)
+{
+    for (int i = 0; i < registry->entryCount; ++i)
+    {
+        glDeleteTextures(1, &registry->entries[i].texture);
+    }
+    free(registry->entries);
+    memset(registry, 0, sizeof(*registry));
+}
+
+// Identical source bytes skip the pixel comparison; a different file can still decode to the same pixels.
+static TexRegistryEntry* FindShared(TexRegistry* registry, uint64_t sourceHash, uint64_t pixelHash)
+{
+    for (int i = 0; i < registry->entryCount; ++i)
+    {
+        TexRegistryEntry* entry = registry->entries + i;
+        if (entry->sourceHash == sourceHash)
+        {
+            ++registry->sourceMatchCount;
+        }
+        else if (entry->pixelHash == pixelHash)
+        {
+            ++registry->pixelMatchCount;
+        }
+        else
+        {
+            continue;
+        }
+        ++entry->refCount;
+        return entry;
+    }
+    return NULL;
+}
+
+static void AddEntry(TexRegistry* registry, GLuint texture, size_t bytes, uint64_t sourceHash, uint64_t pixelHash)
+{
+    if (registry->entryCount == registry->entryCapacity)
+    {
+        registry->entryCapacity = registry->entryCapacity ? registry->entryCapacity * 2 : 16;
+        registry->entries = realloc(registry->entries, registry->entryCapacity * sizeof(TexRegistryEntry));
+        assert(registry->entries);
+    }
+
+    TexRegistryEntry* entry = registry->entries + registry->entryCount++;
+    entry->sourceHash = sourceHash;
+    entry->pixelHash = pixelHash;
+    entry->texture = texture;
+    entry->refCount = 1;
+    entry->bytes = bytes;
+}
+
+// Returns a texture for the image, creating it only if no live texture has the same
+// source or pixel hash. Every successful call must be paired with TexRegistry_Release.
+GLuint TexRegistry_Acquire(TexRegistry* registry, const Image* image, uint64_t sourceHash, uint64_t pixelHash)
+{
+    TexRegistryEntry* shared = FindShared(registry, sourceHash, pixelHash);
+    if (shared)
+    {
+        return shared->texture;
+    }
+
+    GLuint texture = Image_CreateTexture(image);
+    if (texture)
+    {
+        AddEntry(registry, texture, image->dataSize, sourceHash, pixelHash);
+    }
+    return texture;
+}
+
+// For textures created elsewhere, e.g. by an Uploader: a duplicate of a live texture is
+// deleted in favour of the shared one. Pair with TexRegistry_Release like Acquire.
+GLuint TexRegistry_Adopt(TexRegistry* registry, GLuint texture, size_t bytes, uint64_t sourceHash, uint64_t pixelHash)
+{
+    TexRegistryEntry* shared = FindShared(registry, sourceHash, pixelHash);
+    if (shared)
+    {
+        glDeleteTextures(1, &texture);
+        return shared->texture;
+    }
+
+    AddEntry(registry, texture, bytes, sourceHash, pixelHash);
+    return texture;
+}
+
+void TexRegistry_Release(TexRegistry* registry, GLuint texture)
+{
+    for (int i = 0; i < registry->entryCount; ++i)
+    {
+        TexRegistryEntry* entry = registry->entries + i;
+        if (entry->texture != texture)
+        {
+            continue;
+        }
+        if (--entry->refCount == 0)
+        {
+            glDeleteTextures(1, &entry->texture);
+            *entry = registry->entries[--registry->entryCount];
+        }
+        return;
+    }
+}
+
+// VRAM the shared textures would have taken again had every load uploaded its own copy.
+size_t TexRegistry_SavedBytes(const TexRegistry* registry)
+{
+    size_t result = 0;
+    for (int i = 0; i < registry->entryCount; ++i)
+    {
+        const TexRegistryEntry* entry = registry->entries + i;
+        result += (size_t)(entry->refCount - 1) * entry->bytes;
+    }
+    return result;
+}
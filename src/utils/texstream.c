@@ -0,0 +1,227 @@
+#include "utils/texstream.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+static void SetBaseLevel(StreamedTexture* texture, int base)
+{
+    glBindTexture(GL_TEXTURE_2D, texture->texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, base);
+    texture->residentBase = base;
+}
+
+static void DropFinestLevel(TexStream* stream, StreamedTexture* texture)
+{
+    int level = texture->residentBase;
+    size_t bytes = texture->image.levels[level].size;
+
+    // Raise the base first so the texture stays complete, then give the level's memory back.
+    SetBaseLevel(texture, level + 1);
+    glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+
+    texture->residentBytes -= bytes;
+    stream->residentBytes -= bytes;
+    ++stream->evictionCount;
+}
+
+// Least recently used first; among textures used this frame only those holding more than they asked for.
+static StreamedTexture* FindVictim(TexStream* stream, const StreamedTexture* keep)
+{
+    StreamedTexture* result = NULL;
+    for (int i = 0; i < stream->textureCount; ++i)
+    {
+        StreamedTexture* texture = stream->textures + i;
+        if (texture == keep || texture->residentBase >= texture->tailBase)
+        {
+            continue;
+        }
+        if (texture->lastUsedFrame == stream->frame && texture->residentBase >= texture->requestedBase)
+        {
+            continue;
+        }
+        if (!result || texture->lastUsedFrame < result->lastUsedFrame ||
+            (texture->lastUsedFrame == result->lastUsedFrame && texture->residentBytes > result->residentBytes))
+        {
+            result = texture;
+        }
+    }
+    return result;
+}
+
+static int MakeRoom(TexStream* stream, size_t bytes, const StreamedTexture* keep)
+{
+    while (stream->residentBytes + bytes > stream->budget)
+    {
+        StreamedTexture* victim = FindVictim(stream, keep);
+        if (!victim)
+        {
+            return 0;
+        }
+        DropFinestLevel(stream, victim);
+    }
+    return 1;
+}
+
+void TexStream_Init(TexStream* stream, size_t budget, size_t uploadBytesPerFrame)
+{
+    memset(stream, 0, sizeof(*stream));
+    stream->budget = budget;
+    stream->uploadBytesPerFrame = uploadBytesPerFrame;
+}
+
+void TexStream_Free(TexStream* stream)
+{
+    for (int i = 0; i < stream->textureCount; ++i)
+    {
+        glDeleteTextures(1, &stream->textures[i].texture);
+        Image_Free(&stream->textures[i].image);
+    }
+    free(stream->textures);
+    memset(stream, 0, sizeof(*stream));
+}
+
+// Takes ownership of the image and uploads its mip tail; returns a handle or -1.
+int TexStream_Add(TexStream* stream, Image* image)
+{
+    if (stream->textureCount == stream->textureCapacity)
+    {
+        int capacity = stream->textureCapacity ? stream->textureCapacity * 2 : 16;
+        StreamedTexture* textures = realloc(stream->textures, capacity * sizeof(StreamedTexture));
+        if (!textures)
+        {
+            return -1;
+        }
+        stream->textures = textures;
+        stream->textureCapacity = capacity;
+    }
+
+    StreamedTexture* texture = stream->textures + stream->textureCount;
+    memset(texture, 0, sizeof(*texture));
+    texture->image = *image;
+    memset(image, 0, sizeof(*image));
+
+    const Image* source = &texture->image;
+    texture->tailBase = source->levelCount - 1;
+    while (texture->tailBase > 0)
+    {
+        const ImageLevel* level = source->levels + texture->tailBase - 1;
+        if (level->width > TEXSTREAM_TAIL_SIZE || level->height > TEXSTREAM_TAIL_SIZE)
+        {
+            break;
+        }
+        --texture->tailBase;
+    }
+
+    glGenTextures(1, &texture->texture);
+    glBindTexture(GL_TEXTURE_2D, texture->texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, source->levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, source->levelCount - 1);
+
+    // The tail is always resident, even over budget, so every texture can be sampled.
+    for (int i = source->levelCount - 1; i >= texture->tailBase; --i)
+    {
+        Image_DefineLevel(source, GL_TEXTURE_2D, i);
+        texture->residentBytes += source->levels[i].size;
+    }
+    SetBaseLevel(texture, texture->tailBase);
+    texture->requestedBase = -1;
+    stream->residentBytes += texture->residentBytes;
+
+    return stream->textureCount++;
+}
+
+// screenSize is the larger on-screen extent in pixels the texture is drawn at this frame.
+void TexStream_Request(TexStream* stream, int handle, float screenSize)
+{
+    StreamedTexture* texture = stream->textures + handle;
+    const ImageLevel* top = texture->image.levels;
+    float size = (float)(top->width > top->height ? top->width : top->height);
+
+    int level = 0;
+    if (screenSize > 0.0f && size > screenSize)
+    {
+        level = (int)floorf(log2f(size / screenSize));
+    }
+    else if (screenSize <= 0.0f)
+    {
+        level = texture->tailBase;
+    }
+    if (level > texture->tailBase)
+    {
+        level = texture->tailBase;
+    }
+
+    if (texture->requestedBase < 0 || level < texture->requestedBase)
+    {
+        texture->requestedBase = level;
+    }
+    texture->lastUsedFrame = stream->frame;
+}
+
+GLuint TexStream_Texture(const TexStream* stream, int handle)
+{
+    return stream->textures[handle].texture;
+}
+
+// Once per frame: streams requested levels in, one level at a time and at most
+// uploadBytesPerFrame, evicting least recently used top mips to stay in budget.
+void TexStream_Update(TexStream* stream)
+{
+    size_t uploaded = 0;
+
+    for (;;)
+    {
+        StreamedTexture* best = NULL;
+        for (int i = 0; i < stream->textureCount; ++i)
+        {
+            StreamedTexture* texture = stream->textures + i;
+            if (texture->requestedBase < 0 || texture->requestedBase >= texture->residentBase)
+            {
+                continue;
+            }
+            if (!best || texture->residentBase - texture->requestedBase > best->residentBase - best->requestedBase)
+            {
+                best = texture;
+            }
+        }
+        if (!best)
+        {
+            break;
+        }
+
+        int level = best->residentBase - 1;
+        size_t bytes = best->image.levels[level].size;
+        if (uploaded > 0 && uploaded + bytes > stream->uploadBytesPerFrame)
+        {
+            break;
+        }
+        if (!MakeRoom(stream, bytes, best))
+        {
+            // Nothing left to evict for it this frame; settle for what is resident.
+            best->requestedBase = best->residentBase;
+            continue;
+        }
+
+        glBindTexture(GL_TEXTURE_2D, best->texture);
+        Image_DefineLevel(&best->image, GL_TEXTURE_2D, level);
+        SetBaseLevel(best, level);
+        best->residentBytes += bytes;
+        stream->residentBytes += bytes;
+        uploaded += bytes;
+        ++stream->uploadCount;
+    }
+
+    // The budget may have shrunk since the last frame.
+    MakeRoom(stream, 0, NULL);
+
+    for (int i = 0; i < stream->textureCount; ++i)
+    {
+        stream->textures[i].requestedBase = -1;
+    }
+    ++stream->frame;
+}
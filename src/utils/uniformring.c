@@ -0,0 +1,114 @@
+#include "utils/uniformring.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+// frameSize is the most uniform data one frame may pack.
+void UniformRing_Init(UniformRing* ring, size_t frameSize)
+{
+    memset(ring, 0, sizeof(*ring));
+
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    ring->alignment = alignment > 0 ? (size_t)alignment : 256;
+    ring->frameSize = (frameSize + ring->alignment - 1) / ring->alignment * ring->alignment;
+    ring->staging = malloc(ring->frameSize);
+    assert(ring->staging);
+    ring->frame = UNIFORMRING_FRAMES - 1;
+    for (int i = 0; i < UNIFORMRING_MAX_BINDINGS; ++i)
+    {
+        ring->boundOffsets[i] = -1;
+    }
+
+    glGenBuffers(1, &ring->buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, ring->buffer);
+    glBufferData(GL_UNIFORM_BUFFER, (GLsizeiptr)(ring->frameSize * UNIFORMRING_FRAMES), NULL, GL_DYNAMIC_DRAW);
+}
+
+void UniformRing_Free(UniformRing* ring)
+{
+    for (int i = 0; i < UNIFORMRING_FRAMES; ++i)
+    {
+        if (ring->fences[i])
+        {
+            glDeleteSync(ring->fences[i]);
+        }
+    }
+    glDeleteBuffers(1, &ring->buffer);
+    free(ring->staging);
+    memset(ring, 0, sizeof(*ring));
+}
+
+// Moves on to the next region, waiting only if the GPU has not finished the frame
+// that last used it.
+void UniformRing_BeginFrame(UniformRing* ring)
+{
+    ring->frame = (ring->frame + 1) % UNIFORMRING_FRAMES;
+    GLsync fence = ring->fences[ring->frame];
+    if (fence)
+    {
+        glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+        glDeleteSync(fence);
+        ring->fences[ring->frame] = NULL;
+    }
+    ring->head = 0;
+    ring->uploaded = 0;
+}
+
+// Returns where to pack size bytes and their offset in the buffer for UniformRing_Bind,
+// or NULL when the frame's region is full.
+void* UniformRing_Alloc(UniformRing* ring, size_t size, GLintptr* offset)
+{
+    size_t start = (ring->head + ring->alignment - 1) / ring->alignment * ring->alignment;
+    if (start + size > ring->frameSize)
+    {
+        return NULL;
+    }
+    ring->head = start + size;
+    *offset = (GLintptr)(ring->frame * ring->frameSize + start);
+    return ring->staging + start;
+}
+
+// Sends everything allocated since the last upload in one call.
+void UniformRing_Upload(UniformRing* ring)
+{
+    if (ring->head == ring->uploaded)
+    {
+        return;
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, ring->buffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, (GLintptr)(ring->frame * ring->frameSize + ring->uploaded),
+                    (GLsizeiptr)(ring->head - ring->uploaded), ring->staging + ring->uploaded);
+    ring->uploaded = ring->head;
+    ++ring->uploadCount;
+}
+
+// Uploads first if the range is not on the GPU yet, so allocate a frame's blocks
+// before binding any of them to keep it at one upload.
+void UniformRing_Bind(UniformRing* ring, GLuint binding, GLintptr offset, GLsizeiptr size)
+{
+    if ((size_t)(offset + size) > ring->frame * ring->frameSize + ring->uploaded)
+    {
+        UniformRing_Upload(ring);
+    }
+
+    if (binding < UNIFORMRING_MAX_BINDINGS)
+    {
+        if (ring->boundOffsets[binding] == offset && ring->boundSizes[binding] == size)
+        {
+            ++ring->skippedBindCount;
+            return;
+        }
+        ring->boundOffsets[binding] = offset;
+        ring->boundSizes[binding] = size;
+    }
+    glBindBufferRange(GL_UNIFORM_BUFFER, binding, ring->buffer, offset, size);
+    ++ring->bindCount;
+}
+
+// After the frame's last draw that reads from the ring.
+void UniformRing_EndFrame(UniformRing* ring)
+{
+    ring->fences[ring->frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
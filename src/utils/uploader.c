@@ -0,0 +1,239 @@
+#include "utils/uploader.h"
+#include "utils/utils.h"
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <assert.h>
+#include <pthread.h>
+
+// One thread with its own context, shared with the window's, so object creation and
+// uploads no longer stall the render thread. Every finished job carries a fence.
+// Texture jobs join the queue only once the loader has decoded them, so a slow decode
+// never holds up the jobs submitted after it.
+struct Uploader
+{
+    GLFWwindow* context;
+    Loader* loader;
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t jobAdded;
+    pthread_cond_t jobDone;
+    UploadJob* head;
+    UploadJob* tail;
+    // Texture jobs still with the loader.
+    int decodingCount;
+    int quit;
+};
+
+// Call with the mutex held.
+static void Enqueue(Uploader* uploader, UploadJob* job)
+{
+    if (uploader->tail)
+    {
+        uploader->tail->next = job;
+    }
+    else
+    {
+        uploader->head = job;
+    }
+    uploader->tail = job;
+    pthread_cond_signal(&uploader->jobAdded);
+}
+
+// Loader thread: the image is decoded, so its upload can no longer block the queue.
+static void ImageDecoded(ImageJob* image, void* userData)
+{
+    Uploader* uploader = userData;
+    UploadJob* job = (UploadJob*)((char*)image - offsetof(UploadJob, image));
+
+    pthread_mutex_lock(&uploader->mutex);
+    --uploader->decodingCount;
+    Enqueue(uploader, job);
+    pthread_mutex_unlock(&uploader->mutex);
+}
+
+static GLuint UploadTexture(UploadJob* job)
+{
+    if (!job->image.success)
+    {
+        return 0;
+    }
+
+    GLuint result = Image_CreateTexture(&job->image.image);
+    job->size = (GLsizeiptr)job->image.image.dataSize;
+    Image_Free(&job->image.image);
+    return result;
+}
+
+static GLuint UploadBuffer(UploadJob* job)
+{
+    GLuint result;
+    glGenBuffers(1, &result);
+    glBindBuffer(job->target, result);
+    glBufferData(job->target, job->size, job->data, job->usage);
+    glBindBuffer(job->target, 0);
+    return result;
+}
+
+static void* UploaderThread(void* param)
+{
+    Uploader* uploader = param;
+    glfwMakeContextCurrent(uploader->context);
+
+    for (;;)
+    {
+        pthread_mutex_lock(&uploader->mutex);
+        while (!uploader->head && (!uploader->quit || uploader->decodingCount))
+        {
+            pthread_cond_wait(&uploader->jobAdded, &uploader->mutex);
+        }
+        if (!uploader->head)
+        {
+            pthread_mutex_unlock(&uploader->mutex);
+            break;
+        }
+        UploadJob* job = uploader->head;
+        uploader->head = job->next;
+        if (!uploader->head)
+        {
+            uploader->tail = NULL;
+        }
+        pthread_mutex_unlock(&uploader->mutex);
+
+        GLuint name = job->type == UploadType_Texture ? UploadTexture(job) : UploadBuffer(job);
+        GLsync fence = 0;
+        if (name)
+        {
+            // Flushed so another context waiting on the fence cannot wait forever.
+            fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            glFlush();
+        }
+
+        pthread_mutex_lock(&uploader->mutex);
+        job->name = name;
+        job->fence = fence;
+        job->success = name != 0;
+        job->done = 1;
+        pthread_cond_broadcast(&uploader->jobDone);
+        pthread_mutex_unlock(&uploader->mutex);
+    }
+
+    glfwMakeContextCurrent(NULL);
+    return NULL;
+}
+
+// Call on the main thread. Texture jobs are decoded by loader, which must outlive the uploader.
+Uploader* Uploader_Create(GLFWwindow* window, Loader* loader)
+{
+    GLFWwindow* context = Utils_CreateSharedContext(window);
+    if (!context)
+    {
+        return NULL;
+    }
+
+    Uploader* result = calloc(1, sizeof(Uploader));
+    assert(result);
+    result->context = context;
+    result->loader = loader;
+
+    pthread_mutex_init(&result->mutex, NULL);
+    pthread_cond_init(&result->jobAdded, NULL);
+    pthread_cond_init(&result->jobDone, NULL);
+
+    if (pthread_create(&result->thread, NULL, UploaderThread, result))
+    {
+        pthread_cond_destroy(&result->jobDone);
+        pthread_cond_destroy(&result->jobAdded);
+        pthread_mutex_destroy(&result->mutex);
+        glfwDestroyWindow(context);
+        free(result);
+        return NULL;
+    }
+
+    return result;
+}
+
+// Call on the main thread; finishes every submitted job first.
+void Uploader_Destroy(Uploader* uploader)
+{
+    pthread_mutex_lock(&uploader->mutex);
+    uploader->quit = 1;
+    pthread_cond_broadcast(&uploader->jobAdded);
+    pthread_mutex_unlock(&uploader->mutex);
+
+    pthread_join(uploader->thread, NULL);
+    glfwDestroyWindow(uploader->context);
+
+    pthread_cond_destroy(&uploader->jobDone);
+    pthread_cond_destroy(&uploader->jobAdded);
+    pthread_mutex_destroy(&uploader->mutex);
+    free(uploader);
+}
+
+void Uploader_Submit(Uploader* uploader, UploadJob* job)
+{
+    job->name = 0;
+    job->fence = 0;
+    job->success = 0;
+    job->done = 0;
+    job->next = NULL;
+
+    if (job->type == UploadType_Texture)
+    {
+        pthread_mutex_lock(&uploader->mutex);
+        ++uploader->decodingCount;
+        pthread_mutex_unlock(&uploader->mutex);
+
+        job->image.onDone = ImageDecoded;
+        job->image.userData = uploader;
+        Loader_Submit(uploader->loader, &job->image);
+        return;
+    }
+
+    pthread_mutex_lock(&uploader->mutex);
+    Enqueue(uploader, job);
+    pthread_mutex_unlock(&uploader->mutex);
+}
+
+// Render thread, never blocks: true once the job is done and its fence has signalled,
+// after which job->name can be bound. Failed jobs are ready with success == 0.
+int Uploader_IsReady(Uploader* uploader, UploadJob* job)
+{
+    pthread_mutex_lock(&uploader->mutex);
+    int done = job->done;
+    pthread_mutex_unlock(&uploader->mutex);
+    if (!done)
+    {
+        return 0;
+    }
+
+    if (job->fence)
+    {
+        if (glClientWaitSync(job->fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+        {
+            return 0;
+        }
+        glDeleteSync(job->fence);
+        job->fence = 0;
+    }
+    return 1;
+}
+
+// Render thread: blocks until the job is done, then orders later GL commands after its
+// upload on the GPU rather than stalling the CPU for it.
+void Uploader_Wait(Uploader* uploader, UploadJob* job)
+{
+    pthread_mutex_lock(&uploader->mutex);
+    while (!job->done)
+    {
+        pthread_cond_wait(&uploader->jobDone, &uploader->mutex);
+    }
+    pthread_mutex_unlock(&uploader->mutex);
+
+    if (job->fence)
+    {
+        glWaitSync(job->fence, 0, GL_TIMEOUT_IGNORED);
+        glDeleteSync(job->fence);
+        job->fence = 0;
+    }
+}
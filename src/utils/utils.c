@@ -2,9 +2,10 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 
-GLFWwindow* Utils_CreateWindow(const char* title)
+static void SetContextHints(void)
 {
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -12,6 +13,11 @@ GLFWwindow* Utils_CreateWindow(const char* title)
 #if __APPLE__
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
+}
+
+GLFWwindow* Utils_CreateWindow(const char* title)
+{
+    SetContextHints();
 
     GLFWwindow* result = glfwCreateWindow(800, 600, title, NULL, NULL);
 
@@ -24,6 +30,17 @@ GLFWwindow* Utils_CreateWindow(const char* title)
     return result;
 }
 
+// A hidden 1x1 window whose context shares objects with window's, for another thread
+// to make current. Like every GLFW window it must be created and destroyed on the main thread.
+GLFWwindow* Utils_CreateSharedContext(GLFWwindow* window)
+{
+    SetContextHints();
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* result = glfwCreateWindow(1, 1, "", NULL, window);
+    glfwDefaultWindowHints();
+    return result;
+}
+
 char* Utils_ReadTextFile(const char* fileName)
 {
     FILE *file = fopen(fileName, "r");
@@ -54,37 +71,51 @@ char* Utils_ReadTextFile(const char* fileName)
     return result;
 }
 
-void Utils_CheckShaderState(GLuint shader, GLFWwindow* window)
+unsigned char* Utils_ReadBinaryFile(const char* fileName, size_t* size)
 {
-    int success;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-    if (!success)
+    FILE *file = fopen(fileName, "rb");
+    if (!file)
+    {
+        return NULL;
+    }
+
+    if (fseek(file, 0, SEEK_END))
+    {
+        fclose(file);
+        return NULL;
+    }
+
+    long elementCount = ftell(file);
+    rewind(file);
+    unsigned char* result = malloc(elementCount > 0 ? elementCount : 1);
+    assert(result);
+
+    if (elementCount < 0 || (size_t)elementCount != fread(result, 1, elementCount, file))
+    {
+        free(result);
+        result = NULL;
+    }
+    else
     {
-        int logLen;
-        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLen);
-        char* infoLog = alloca(logLen);
-        
-        glGetShaderInfoLog(shader, logLen, NULL, infoLog);
-        glfwSetWindowShouldClose(window, GLFW_TRUE);
-        fprintf(stderr, "Shader compilation error: %s\n", infoLog);
-        getchar();
+        *size = (size_t)elementCount;
     }
+
+    fclose(file);
+
+    return result;
 }
 
-void Utils_CheckProgramState(GLuint program, GLFWwindow* window)
+int Utils_HasExtension(const char* name)
 {
-    int success;
-    glGetProgramiv(program, GL_LINK_STATUS, &success);
-    if (!success)
+    int extensionCount = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+    for (int i = 0; i < extensionCount; ++i)
     {
-        int logLen;
-        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &logLen);
-        char* infoLog = alloca(logLen);
-
-        glGetProgramInfoLog(program, logLen, NULL, infoLog);
-        glfwSetWindowShouldClose(window, GLFW_TRUE);
-        fprintf(stderr, "Shader program error: %s\n", infoLog);
-        getchar();
+        const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+        if (extension && strcmp(extension, name) == 0)
+        {
+            return 1;
+        }
     }
+    return 0;
 }
-
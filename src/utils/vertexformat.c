@@ -0,0 +1,190 @@
+#include "utils/vertexformat.h"
+
+#include <math.h>
+#include <string.h>
+#include <assert.h>
+
+static float Clamp(float value, float low, float high)
+{
+    return value < low ? low : value > high ? high : value;
+}
+
+static int32_t Quantize(float value, float low, int scale)
+{
+    return (int32_t)lrintf(Clamp(value, low, 1.0f) * (float)scale);
+}
+
+static GLsizei ElementSize(const VertexElement* element)
+{
+    switch (element->encoding)
+    {
+        case VertexEncoding_Float: return 4 * element->componentCount;
+        case VertexEncoding_Half:
+        case VertexEncoding_Snorm16:
+        case VertexEncoding_Unorm16: return 2 * element->componentCount;
+        case VertexEncoding_Snorm10: return 4;
+        case VertexEncoding_Unorm8: return element->componentCount;
+    }
+    return 0;
+}
+
+// Round to nearest even, like the GPU's own conversions; overflow becomes infinity.
+uint16_t VertexFormat_Half(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000;
+    uint32_t exponent = (bits >> 23) & 0xFF;
+    uint32_t mantissa = bits & 0x7FFFFF;
+
+    if (exponent == 0xFF)
+    {
+        return (uint16_t)(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+    }
+    int halfExponent = (int)exponent - 127 + 15;
+    if (halfExponent >= 31)
+    {
+        return (uint16_t)(sign | 0x7C00);
+    }
+
+    uint32_t result;
+    uint32_t rest;
+    uint32_t halfway;
+    if (halfExponent <= 0)
+    {
+        // Subnormal: the implicit bit becomes explicit and shifts down with the rest.
+        if (halfExponent < -10)
+        {
+            return (uint16_t)sign;
+        }
+        mantissa |= 0x800000;
+        int shift = 14 - halfExponent;
+        result = mantissa >> shift;
+        rest = mantissa & ((1u << shift) - 1);
+        halfway = 1u << (shift - 1);
+    }
+    else
+    {
+        result = ((uint32_t)halfExponent << 10) | (mantissa >> 13);
+        rest = mantissa & 0x1FFF;
+        halfway = 0x1000;
+    }
+    // A carry out of the mantissa correctly bumps the exponent.
+    if (rest > halfway || (rest == halfway && (result & 1)))
+    {
+        ++result;
+    }
+    return (uint16_t)(sign | result);
+}
+
+void VertexFormat_Init(VertexFormat* format, const VertexElement* elements, int elementCount)
+{
+    memset(format, 0, sizeof(*format));
+    assert(elementCount <= MESHPOOL_MAX_ATTRIBUTES);
+    memcpy(format->elements, elements, elementCount * sizeof(VertexElement));
+    format->elementCount = elementCount;
+
+    GLuint offset = 0;
+    for (int i = 0; i < elementCount; ++i)
+    {
+        const VertexElement* element = elements + i;
+        MeshAttribute* attribute = format->attributes + i;
+        attribute->index = element->index;
+        attribute->size = element->componentCount;
+        attribute->offset = offset;
+        attribute->normalized = GL_TRUE;
+        switch (element->encoding)
+        {
+            case VertexEncoding_Float: attribute->type = GL_FLOAT; attribute->normalized = GL_FALSE; break;
+            case VertexEncoding_Half: attribute->type = GL_HALF_FLOAT; attribute->normalized = GL_FALSE; break;
+            case VertexEncoding_Snorm16: attribute->type = GL_SHORT; break;
+            case VertexEncoding_Unorm16: attribute->type = GL_UNSIGNED_SHORT; break;
+            // GL 3.3 takes packed formats only with all four components.
+            case VertexEncoding_Snorm10: attribute->type = GL_INT_2_10_10_10_REV; attribute->size = 4; break;
+            case VertexEncoding_Unorm8: attribute->type = GL_UNSIGNED_BYTE; break;
+        }
+        offset += ((GLuint)ElementSize(element) + 3) & ~3u;
+        format->sourceComponentCount += element->componentCount;
+    }
+    format->vertexSize = (GLsizei)offset;
+}
+
+// destination holds vertexCount * format->vertexSize bytes; padding is zeroed.
+void VertexFormat_Pack(const VertexFormat* format, const float* source, int vertexCount, void* destination)
+{
+    unsigned char* vertex = destination;
+    memset(destination, 0, (size_t)vertexCount * format->vertexSize);
+
+    for (int v = 0; v < vertexCount; ++v)
+    {
+        for (int i = 0; i < format->elementCount; ++i)
+        {
+            const VertexElement* element = format->elements + i;
+            unsigned char* out = vertex + format->attributes[i].offset;
+            int count = element->componentCount;
+            switch (element->encoding)
+            {
+                case VertexEncoding_Float:
+                    memcpy(out, source, count * sizeof(float));
+                    break;
+                case VertexEncoding_Half:
+                    for (int c = 0; c < count; ++c)
+                    {
+                        ((uint16_t*)out)[c] = VertexFormat_Half(source[c]);
+                    }
+                    break;
+                case VertexEncoding_Snorm16:
+                    for (int c = 0; c < count; ++c)
+                    {
+                        ((int16_t*)out)[c] = (int16_t)Quantize(source[c], -1.0f, 32767);
+                    }
+                    break;
+                case VertexEncoding_Unorm16:
+                    for (int c = 0; c < count; ++c)
+                    {
+                        ((uint16_t*)out)[c] = (uint16_t)Quantize(source[c], 0.0f, 65535);
+                    }
+                    break;
+                case VertexEncoding_Snorm10:
+                {
+                    // x in the low bits; w gets two bits, so only -1, 0 or 1.
+                    uint32_t packed = 0;
+                    for (int c = 0; c < count && c < 4; ++c)
+                    {
+                        int bits = c < 3 ? 10 : 2;
+                        int32_t value = Quantize(source[c], -1.0f, (1 << (bits - 1)) - 1);
+                        packed |= ((uint32_t)value & ((1u << bits) - 1)) << (c * 10);
+                    }
+                    memcpy(out, &packed, sizeof(packed));
+                    break;
+                }
+                case VertexEncoding_Unorm8:
+                    for (int c = 0; c < count; ++c)
+                    {
+                        out[c] = (unsigned char)Quantize(source[c], 0.0f, 255);
+                    }
+                    break;
+            }
+            source += count;
+        }
+        vertex += format->vertexSize;
+    }
+}
+
+// Points the bound VAO's attributes at the buffer bound to GL_ARRAY_BUFFER. locations
+// overrides the elements' indices, e.g. with reflected ones; NULL keeps them.
+void VertexFormat_Apply(const VertexFormat* format, const GLint* locations)
+{
+    for (int i = 0; i < format->elementCount; ++i)
+    {
+        const MeshAttribute* attribute = format->attributes + i;
+        GLint location = locations ? locations[i] : (GLint)attribute->index;
+        if (location < 0)
+        {
+            continue;
+        }
+        glVertexAttribPointer((GLuint)location, attribute->size, attribute->type, attribute->normalized,
+                              format->vertexSize, (void*)(uintptr_t)attribute->offset);
+        glEnableVertexAttribArray((GLuint)location);
+    }
+}
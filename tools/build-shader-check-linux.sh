@@ -0,0 +1,9 @@
+#!/bin/sh
+
+# Headless shader checker for CI; needs EGL, e.g. Mesa's llvmpipe without a GPU.
+# GLFW is linked for the shared utils but never initialised.
+INCLUDES="-I../include"
+LINKER_FLAGS="-lglfw -lEGL -lpthread -ldl -lm"
+SOURCES="shader_check.c ../src/*/*.c"
+
+cc $SOURCES $INCLUDES $LINKER_FLAGS -Wall -O2 -o shader_check.out
@@ -0,0 +1,21 @@
+#!/bin/sh
+
+# Compiles every shader pair the examples build and fills each example's shadercache/,
+# so launches on the same driver start warm. Exits non-zero if any pair fails.
+# Keep the pairs in step with the examples.
+TOOLS=$(cd "$(dirname "$0")" && pwd)
+CHECK="$TOOLS/shader_check.out"
+STATUS=0
+
+cd "$TOOLS/../glfw-shaders-ex" || exit 1
+"$CHECK" upside_down.vert orange.frag offset.vert orange.frag default.vert colorPos.frag || STATUS=1
+
+cd "$TOOLS/../glfw-textures-ex" || exit 1
+"$CHECK" texture.vert texture.frag texture_array.vert texture_array.frag || STATUS=1
+
+# main.c's second solution compiles ex1 as is, the third as two variants.
+cd "$TOOLS/../glfw-triangle-ex" || exit 1
+"$CHECK" ex1.vert ex1.frag -D "" ex1.vert ex1.frag -D "COLOR=vec4(1.0f, 1.0f, 0.0f, 1.0f)" ex1.vert ex1.frag \
+    instanced.vert instanced.frag || STATUS=1
+
+exit $STATUS
@@ -0,0 +1,82 @@
+#include "utils/hash.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Writes the given shader files to stdout as a table of EmbeddedShader entries, so an
+// example can compile its shaders in:
+//   embed_shaders.out *.vert *.frag > embedded_shaders.h
+// Names are kept exactly as given, which is how ShaderFiles_Read looks them up.
+
+// Not Utils_ReadTextFile: the tool links hash.c alone, without GLFW.
+static char* ReadFile(const char* fileName)
+{
+    FILE* file = fopen(fileName, "rb");
+    if (!file)
+    {
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    rewind(file);
+    char* result = size >= 0 ? calloc((size_t)size + 1, 1) : NULL;
+    if (result && fread(result, 1, (size_t)size, file) != (size_t)size)
+    {
+        free(result);
+        result = NULL;
+    }
+    fclose(file);
+    return result;
+}
+
+static void WriteString(const char* text)
+{
+    printf("        \"");
+    for (const unsigned char* c = (const unsigned char*)text; *c; ++c)
+    {
+        if (*c == '\n')
+        {
+            printf("\\n\"\n        \"");
+        }
+        else if (*c == '"' || *c == '\\')
+        {
+            printf("\\%c", *c);
+        }
+        else if (*c < 0x20 || *c >= 0x7F)
+        {
+            // Three octal digits always, so a following digit is never absorbed.
+            printf("\\%03o", *c);
+        }
+        else
+        {
+            putchar(*c);
+        }
+    }
+    printf("\"");
+}
+
+int main(int argc, char** argv)
+{
+    printf("// Generated by tools/embed_shaders.c; do not edit.\n");
+    printf("#include \"utils/shaderfiles.h\"\n\n");
+    printf("static const EmbeddedShader embeddedShaders[] =\n{\n");
+
+    for (int i = 1; i < argc; ++i)
+    {
+        char* source = ReadFile(argv[i]);
+        if (!source)
+        {
+            fprintf(stderr, "embed_shaders: cannot read %s\n", argv[i]);
+            return 1;
+        }
+        printf("    {\n        \"%s\", 0x%016llxull,\n", argv[i], (unsigned long long)Hash_String(source, 0));
+        WriteString(source);
+        printf("\n    },\n");
+        free(source);
+    }
+
+    // Keeps the array non-empty when a directory has no shaders.
+    printf("    {0}\n};\n\n");
+    printf("#define EMBEDDED_SHADER_COUNT %d\n", argc - 1);
+    return 0;
+}
@@ -0,0 +1,413 @@
+#include "glad/glad.h"
+#include "utils/glext.h"
+#include "utils/progcache.h"
+#include "utils/preprocessor.h"
+#include "utils/shadervariants.h"
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+// Compiles and links shader pairs on a headless context, so broken shaders fail a CI
+// run instead of a launch, and stores the linked binaries in a program cache:
+//   shader_check.out [-c cachedir] [-j jobs] [[-D defines] vert frag]...
+// -D applies to the next pair only and takes the same define list as
+// ShaderVariants_Declare. Pairs are preprocessed like the examples do, so the cache
+// keys match theirs when run from the example's directory on the same driver.
+// Exits non-zero if any pair fails.
+
+#define SHADERCHECK_MAX_JOBS 64
+
+typedef struct
+{
+    const char* vertPath;
+    const char* fragPath;
+    const char* defines;
+} ShaderPair;
+
+typedef struct
+{
+    char* data;
+    size_t size;
+    size_t capacity;
+} Output;
+
+static void Print(Output* output, const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+    if (length <= 0)
+    {
+        return;
+    }
+
+    if (output->size + length + 1 > output->capacity)
+    {
+        output->capacity = (output->size + length + 1) * 2;
+        output->data = realloc(output->data, output->capacity);
+        if (!output->data)
+        {
+            abort();
+        }
+    }
+    va_start(args, format);
+    vsnprintf(output->data + output->size, output->capacity - output->size, format, args);
+    va_end(args);
+    output->size += length;
+}
+
+static double Now(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+static void PrintIncludeError(const char* name, const char* stage, const char* log, void* userData)
+{
+    Print(userData, "    %s\n", log);
+}
+
+static int ReadNumber(const char** text, int* value)
+{
+    if (!isdigit((unsigned char)**text))
+    {
+        return 0;
+    }
+    *value = (int)strtol(*text, (char**)text, 10);
+    return 1;
+}
+
+// Finds a driver location in one log line: "N:line(col)" (Mesa), "N:line:" (AMD,
+// Apple) or "N(line)" (NVIDIA), where N is the #line source number.
+static const char* FindLocation(const char* line, const char* end, int* source, int* lineNumber, int* column,
+                                const char** after)
+{
+    for (const char* c = line; c < end; ++c)
+    {
+        if (!isdigit((unsigned char)*c) || (c > line && (isdigit((unsigned char)c[-1]) || isalpha((unsigned char)c[-1]))))
+        {
+            continue;
+        }
+
+        const char* text = c;
+        *column = 0;
+        ReadNumber(&text, source);
+        if (*text == ':' && (++text, ReadNumber(&text, lineNumber)))
+        {
+            if (*text == '(' && (++text, ReadNumber(&text, column)) && *text == ')')
+            {
+                *after = text + 1;
+                return c;
+            }
+            if (*text == ':')
+            {
+                *after = text;
+                return c;
+            }
+        }
+        else if (*text == '(' && (++text, ReadNumber(&text, lineNumber)) && *text == ')')
+        {
+            *after = text + 1;
+            return c;
+        }
+    }
+    return NULL;
+}
+
+// Rewrites source numbers into the paths the expansion spliced in, for editors and CI
+// annotations that understand "path:line:column".
+static void PrintLog(Output* output, const char* log, const ShaderExpansion* expansion)
+{
+    for (const char* line = log; *line;)
+    {
+        const char* end = strchr(line, '\n');
+        if (!end)
+        {
+            end = line + strlen(line);
+        }
+
+        int source, lineNumber, column;
+        const char* after;
+        const char* location = FindLocation(line, end, &source, &lineNumber, &column, &after);
+        if (location && source >= 0 && source < expansion->dependencyCount)
+        {
+            Print(output, "    %.*s%s:%d", (int)(location - line), line, expansion->dependencies[source].path, lineNumber);
+            if (column)
+            {
+                Print(output, ":%d", column);
+            }
+            Print(output, "%.*s\n", (int)(end - after), after);
+        }
+        else if (end > line)
+        {
+            Print(output, "    %.*s\n", (int)(end - line), line);
+        }
+        line = *end ? end + 1 : end;
+    }
+}
+
+static GLuint Compile(Output* output, GLenum type, const char* source, const ShaderExpansion* expansion)
+{
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
+
+    GLint success;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success)
+    {
+        GLint logLength = 0;
+        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
+        char* log = calloc((size_t)logLength + 1, 1);
+        glGetShaderInfoLog(shader, logLength, NULL, log);
+        PrintLog(output, log, expansion);
+        free(log);
+        glDeleteShader(shader);
+        shader = 0;
+    }
+    return shader;
+}
+
+// Returns 1 if the pair linked; everything it has to say goes to output.
+static int CheckPair(ProgCache* cache, Preprocessor* preprocessor, const ShaderPair* pair, Output* output)
+{
+    Output log = {0};
+    preprocessor->userData = &log;
+    const ShaderExpansion* vert = Preprocessor_Expand(preprocessor, pair->vertPath);
+    const ShaderExpansion* frag = Preprocessor_Expand(preprocessor, pair->fragPath);
+
+    int success = vert && frag;
+    if (success)
+    {
+        char* vertSrc = pair->defines ? ShaderVariants_Source(vert->text, pair->defines) : strdup(vert->text);
+        char* fragSrc = pair->defines ? ShaderVariants_Source(frag->text, pair->defines) : strdup(frag->text);
+
+        double start = Now();
+        GLuint vertShdr = Compile(&log, GL_VERTEX_SHADER, vertSrc, vert);
+        GLuint fragShdr = Compile(&log, GL_FRAGMENT_SHADER, fragSrc, frag);
+        success = vertShdr && fragShdr;
+        if (success)
+        {
+            GLuint program = glCreateProgram();
+            glAttachShader(program, vertShdr);
+            glAttachShader(program, fragShdr);
+            ProgCache_PrepareLink(cache, program);
+            glLinkProgram(program);
+
+            GLint linked;
+            glGetProgramiv(program, GL_LINK_STATUS, &linked);
+            if (linked)
+            {
+                ProgCache_Store(cache, ProgCache_Key(vertSrc, fragSrc), program, Now() - start);
+            }
+            else
+            {
+                GLint logLength = 0;
+                glGetProgramiv(program, GL_INFO_LOG_LENGTH, &logLength);
+                char* linkLog = calloc((size_t)logLength + 1, 1);
+                glGetProgramInfoLog(program, logLength, NULL, linkLog);
+                PrintLog(&log, linkLog, vert);
+                free(linkLog);
+            }
+            success = linked;
+            glDeleteProgram(program);
+        }
+        glDeleteShader(vertShdr);
+        glDeleteShader(fragShdr);
+        free(vertSrc);
+        free(fragSrc);
+
+        Print(output, "%s %s + %s", success ? "ok  " : "FAIL", pair->vertPath, pair->fragPath);
+        if (pair->defines)
+        {
+            Print(output, " [%s]", pair->defines);
+        }
+        Print(output, " (%.1f ms)\n", (Now() - start) * 1000.0);
+    }
+    else
+    {
+        Print(output, "FAIL %s + %s\n", pair->vertPath, pair->fragPath);
+    }
+
+    if (log.size)
+    {
+        Print(output, "%s", log.data);
+    }
+    free(log.data);
+    return success;
+}
+
+static void* GetProcAddress(const char* name)
+{
+    return (void*)eglGetProcAddress(name);
+}
+
+// Surfaceless Mesa (llvmpipe without a GPU) where available, else the default display.
+static int CreateContext(void)
+{
+    EGLDisplay display = EGL_NO_DISPLAY;
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay)
+    {
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    }
+    if (display == EGL_NO_DISPLAY)
+    {
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, NULL, NULL) || !eglBindAPI(EGL_OPENGL_API))
+    {
+        return 0;
+    }
+
+    EGLint configAttribs[] = {EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE};
+    EGLConfig config;
+    EGLint configCount = 0;
+    eglChooseConfig(display, configAttribs, &config, 1, &configCount);
+
+    // Same version and profile Utils_CreateWindow asks GLFW for.
+    EGLint contextAttribs[] =
+    {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    EGLContext context = eglCreateContext(display, configCount ? config : NULL, EGL_NO_CONTEXT, contextAttribs);
+    if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+    {
+        return 0;
+    }
+
+    GLExt_SetLoader(GetProcAddress);
+    return gladLoadGLLoader((GLADloadproc)GetProcAddress);
+}
+
+// Runs in its own process with its own context; checks every jobCount-th pair.
+static int RunJob(const char* cacheDir, const ShaderPair* pairs, int pairCount, int job, int jobCount)
+{
+    if (!CreateContext())
+    {
+        fprintf(stderr, "shader_check: cannot create a headless OpenGL 3.3 context\n");
+        return 0;
+    }
+
+    ProgCache cache;
+    ProgCache_Init(&cache, cacheDir);
+    Preprocessor preprocessor;
+    Preprocessor_Init(&preprocessor, PrintIncludeError, NULL);
+
+    int success = 1;
+    for (int i = job; i < pairCount; i += jobCount)
+    {
+        Output output = {0};
+        success = CheckPair(&cache, &preprocessor, pairs + i, &output) && success;
+        // One write per pair keeps the jobs' reports from interleaving.
+        write(STDOUT_FILENO, output.data, output.size);
+        free(output.data);
+    }
+
+    Preprocessor_Free(&preprocessor);
+    return success;
+}
+
+static void PrintUsage(void)
+{
+    fprintf(stderr, "usage: shader_check.out [-c cachedir] [-j jobs] [[-D defines] vert frag]...\n");
+}
+
+int main(int argc, char** argv)
+{
+    const char* cacheDir = "shadercache";
+    long jobCount = sysconf(_SC_NPROCESSORS_ONLN);
+    const char* defines = NULL;
+    ShaderPair* pairs = calloc((size_t)argc, sizeof(ShaderPair));
+    int pairCount = 0;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "-c") == 0 && i + 1 < argc)
+        {
+            cacheDir = argv[++i];
+        }
+        else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+        {
+            jobCount = atol(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-D") == 0 && i + 1 < argc)
+        {
+            defines = argv[++i];
+        }
+        else if (argv[i][0] != '-' && i + 1 < argc)
+        {
+            pairs[pairCount].vertPath = argv[i];
+            pairs[pairCount].fragPath = argv[++i];
+            pairs[pairCount].defines = defines;
+            defines = NULL;
+            ++pairCount;
+        }
+        else
+        {
+            PrintUsage();
+            return 2;
+        }
+    }
+    if (!pairCount)
+    {
+        PrintUsage();
+        return 2;
+    }
+
+    if (jobCount < 1)
+    {
+        jobCount = 1;
+    }
+    if (jobCount > pairCount)
+    {
+        jobCount = pairCount;
+    }
+    if (jobCount > SHADERCHECK_MAX_JOBS)
+    {
+        jobCount = SHADERCHECK_MAX_JOBS;
+    }
+
+    // Processes rather than threads: one context per job, and a driver crash on one
+    // shader fails that job instead of the whole run.
+    int failed = 0;
+    pid_t jobs[SHADERCHECK_MAX_JOBS];
+    for (int job = 0; job < jobCount; ++job)
+    {
+        jobs[job] = fork();
+        if (jobs[job] == 0)
+        {
+            _exit(RunJob(cacheDir, pairs, pairCount, job, (int)jobCount) ? 0 : 1);
+        }
+        if (jobs[job] < 0)
+        {
+            failed = 1;
+        }
+    }
+    for (int job = 0; job < jobCount; ++job)
+    {
+        int status;
+        if (jobs[job] > 0 && (waitpid(jobs[job], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status)))
+        {
+            failed = 1;
+        }
+    }
+
+    free(pairs);
+    return failed;
+}